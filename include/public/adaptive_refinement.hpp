@@ -0,0 +1,81 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <input_parameters.hpp>
+
+struct RefinementLevel
+{
+  size_t intervals;       // along every axis
+  size_t unknowns;
+  double error_estimate;  // Richardson estimate of max |w - u|, infinity on the first level
+  double order;           // convergence order used for the estimate
+  double seconds;         // assembly and solve
+};
+
+struct AdaptiveSolution
+{
+  size_t intervals;  // along every axis of the grid `solution` is given on
+  // Richardson extrapolation of the last two levels on the interior points of the coarser one,
+  // the solution itself when only one level was solved
+  Eigen::VectorXd solution;
+  double error_estimate;  // of the finest solve, the extrapolation is more accurate still
+  bool converged;
+  std::vector<RefinementLevel> levels;
+};
+
+// Solves the box on grids with initial_intervals, 2 * initial_intervals, ... intervals along
+// every axis, until the Richardson estimate of the error drops to `tolerance` or the next grid
+// would have more than max_intervals. Every coarse point is a fine point as well, the difference
+// there gives the estimate and the extrapolated solution. The interpolated coarse solution is
+// the initial guess when the fine grid takes the iterative solver. The scheme is second order,
+// the observed order is used instead once three levels are solved and it is between 1 and 4.
+auto solve_to_tolerance(
+  std::shared_ptr<InputParameters3D> params,
+  double tolerance,
+  size_t initial_intervals = 4,
+  size_t max_intervals = 256
+) -> AdaptiveSolution;
+
+struct GradedLevel
+{
+  size_t x_intervals;
+  size_t y_intervals;
+  size_t z_intervals;
+  size_t unknowns;
+  double error_estimate;  // Richardson estimate of max |w - u| against the coarsened grid
+  double indicator;       // largest curvature_indicator over the intervals of all three axes
+  double seconds;         // assembly and solve on the grid and on the coarsened one
+};
+
+struct GradedSolution
+{
+  std::vector<double> x_points;
+  std::vector<double> y_points;
+  std::vector<double> z_points;
+  Eigen::VectorXd solution;
+  double error_estimate;
+  bool converged;
+  std::vector<GradedLevel> levels;
+};
+
+// Solves the box on the given points and once more on every other point of them, the
+// difference gives a Richardson estimate of the error (second order) for an eighth of the
+// unknowns. Until the estimate drops to `tolerance`, or the refined grid would have more than
+// max_unknowns, every interval whose curvature_indicator (the largest over the grid lines
+// along its axis) exceeds half of the largest one is bisected and the box solved again. The
+// indicator only picks where to refine, its value is an interpolation error and may be well
+// below the error of the scheme. Points are only added, so a boundary layer gets dense points
+// while smooth regions keep the initial ones. The interpolated solution of a level is the
+// initial guess when the next one takes the iterative solver.
+auto refine_to_indicator(
+  std::shared_ptr<InputParameters3D> params,
+  std::vector<double> x_points,
+  std::vector<double> y_points,
+  std::vector<double> z_points,
+  double tolerance,
+  size_t max_unknowns = size_t(1) << 21
+) -> GradedSolution;
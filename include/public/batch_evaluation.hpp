@@ -0,0 +1,25 @@
+#pragma once
+
+#include <span>
+
+#include <defines.hpp>
+
+// Adapters giving a scalar function the batch signature, one call per point
+auto batched(X_Function_type scalar) -> Batch_X_Function_type;
+auto batched(X_Y_Function_type scalar) -> Batch_X_Y_Function_type;
+
+// Calls `batch` once when it is set, `scalar` for every point otherwise
+void evaluate(
+  Batch_X_Function_type const& batch,
+  X_Function_type const& scalar,
+  std::span<double const> x,
+  std::span<double> out
+);
+
+void evaluate(
+  Batch_X_Y_Function_type const& batch,
+  X_Y_Function_type const& scalar,
+  std::span<double const> x,
+  std::span<double const> y,
+  std::span<double> out
+);
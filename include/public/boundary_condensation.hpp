@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include <interface/i_main_matrix_calculator.hpp>
+
+// System over the unknowns that are not first type condition values
+struct CondensedSystem
+{
+  Eigen::SparseMatrix<double> matrix;
+  Eigen::VectorXd g;
+
+  // Number of every kept unknown in the full system
+  std::vector<size_t> kept;
+
+  // Number and value of every eliminated unknown
+  std::vector<size_t> eliminated;
+  Eigen::VectorXd boundary_values;
+};
+
+// Removes rows and columns of the unknowns `calc.is_first_type` reports, their columns
+// are folded into g. Only the stored entries are visited: the folding touches the
+// eliminated columns alone and the kept entries are streamed once into the result.
+// Throws std::invalid_argument when an eliminated row has a nonzero off-diagonal entry.
+auto condense_boundary(
+  IMainMatrixCalculator const& calc,
+  Eigen::SparseMatrix<double> const& matrix,
+  Eigen::VectorXd const& g
+) -> CondensedSystem;
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+// Block sizes up to this one get a fixed-size instantiation of the kernels,
+// larger blocks use dynamic-size Eigen matrices
+inline constexpr size_t max_fixed_block_size = 16;
+
+// Block LU (block Thomas) for a block-tridiagonal matrix with square blocks of
+// `block_size` unknowns: block i holds unknowns i * block_size .. (i + 1) * block_size - 1.
+// For build_main_matrix that is one x = const plane, block_size = ny * nz, so long thin
+// grids give many small blocks, which is where it pays off. Diagonal blocks are
+// factorized with partial pivoting, the work is nx * block_size^3.
+auto block_thomas_solver(
+  Eigen::SparseMatrix<double> const& matrix,
+  Eigen::Ref<Eigen::VectorXd const> g,
+  size_t block_size
+) -> Eigen::VectorXd;
+
+// Same as block_thomas_solver, the solution overwrites `g`
+void block_thomas_solve(
+  Eigen::SparseMatrix<double> const& matrix,
+  Eigen::Ref<Eigen::VectorXd> g,
+  size_t block_size
+);
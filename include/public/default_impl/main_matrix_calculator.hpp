@@ -25,9 +25,13 @@ class DefaultMainMatrixCalculator : public IMainMatrixCalculator
   auto calc_b(Index index) const -> double override;
   auto calc_c(Index index) const -> double override;
   auto calc_g(Index index) const -> double override;
+  void calc_g_edges(std::span<double> g) const override;
+  void calc_g_planes(size_t begin, size_t end, std::span<double> g) const override;
   auto calc_d(Index index) const -> double override;
   auto calc_e(Index index) const -> double override;
 
+  auto is_first_type(Index index) const -> bool override;
+
   auto params() const -> std::shared_ptr<InputParameters> const& { return m_input_p; }
 
   auto x_points() const -> std::vector<double> const& override { return m_x_points; }
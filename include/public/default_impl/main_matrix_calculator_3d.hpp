@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include <interface/i_main_matrix_calculator.hpp>
+#include <input_parameters.hpp>
+
+// Seven-point finite volume scheme for InputParameters3D.
+// Index addresses interior unknowns, (0, 0, 0) is the point (x_points[1], y_points[1], z_points[1]).
+// Every row is scaled by its cell volume, so the operator is symmetric positive definite.
+// calc_a..calc_q return the coupling even when the neighbour lies on the boundary,
+// its value is then moved to calc_g.
+class DefaultMainMatrixCalculator3D : public IMainMatrixCalculator
+{
+ public:
+  // Every axis needs at least two intervals, so that it has an interior point
+  explicit DefaultMainMatrixCalculator3D(
+    std::shared_ptr<InputParameters3D> params,
+    std::vector<double> x_points,
+    std::vector<double> y_points,
+    std::vector<double> z_points
+  );
+
+  auto calc_a(Index index) const -> double override;
+  auto calc_b(Index index) const -> double override;
+  auto calc_c(Index index) const -> double override;
+  auto calc_g(Index index) const -> double override;
+  auto calc_d(Index index) const -> double override;
+  auto calc_e(Index index) const -> double override;
+  auto calc_p(Index index) const -> double override;
+  auto calc_q(Index index) const -> double override;
+
+  auto params() const -> std::shared_ptr<InputParameters3D> const& { return m_input_p; }
+
+  auto x_points() const -> std::vector<double> const& override { return m_x_points; }
+
+  auto y_points() const -> std::vector<double> const& override { return m_y_points; }
+
+  auto z_points() const -> std::vector<double> const& override { return m_z_points; }
+
+  auto interiour_x_points() const -> std::span<double const> override
+  {
+    return {m_x_points.data() + 1, m_x_points.size() - 2};
+  }
+
+  auto interiour_y_points() const -> std::span<double const> override
+  {
+    return {m_y_points.data() + 1, m_y_points.size() - 2};
+  }
+
+  auto interiour_z_points() const -> std::span<double const> override
+  {
+    return {m_z_points.data() + 1, m_z_points.size() - 2};
+  }
+
+ protected:
+  // Flux coefficient k * (face area) / h through the face between grid point `point`
+  // and its neighbour, shifted by -1 or +1 along `axis` (0 - x, 1 - y, 2 - z)
+  auto conductance(Index point, int axis, int shift) const -> double;
+
+  std::shared_ptr<InputParameters3D> m_input_p;
+
+  std::vector<double> m_x_points;
+  std::vector<double> m_y_points;
+  std::vector<double> m_z_points;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+
+#include <Eigen/Dense>
+
+#include <matrix_builder.hpp>
+
+// Seven-point operator whose couplings between planes (i) and lines (j) do not depend on
+// the position once row (i, j, k) is multiplied by row_scale[k]:
+//   w(i-1) + w(i+1) + y_coupling * (w(j-1) + w(j+1)) + L w = row_scale[k] * g
+// L is the tridiagonal operator along z (line_a, line_b, line_c), the same for every line.
+// That is what a uniform grid in x and y with a coefficient constant in x and y gives,
+// the z points may be arbitrary.
+struct SeparableStencil3D
+{
+  GridShape shape;
+
+  double y_coupling = 1;
+
+  Eigen::VectorXd line_a;
+  Eigen::VectorXd line_b;
+  Eigen::VectorXd line_c;
+
+  Eigen::VectorXd row_scale;
+};
+
+/// @return nullopt if couplings of `stencil` vary between planes or lines
+auto extract_separable_stencil(Stencil7 const& stencil) -> std::optional<SeparableStencil3D>;
+
+// Direct solver nesting odd-even reduction across planes, then lines, then points.
+// Buneman's variant of block cyclic reduction is used on the planes and on the lines,
+// blocks are never formed: a reduced block is a polynomial in the block below it and
+// is inverted as a product of shifted solves one level down. Points are solved with
+// odd_even_reduction_solver. Memory stays linear in the number of unknowns.
+// shape.nx and shape.ny must be 2^m - 1, i.e. split_interval with 2^m intervals.
+auto nested_cyclic_reduction_solver(SeparableStencil3D const& op, Eigen::VectorXd const& g)
+  -> Eigen::VectorXd;
+
+// Same as nested_cyclic_reduction_solver, the solution overwrites `g`
+void nested_cyclic_reduction_solve(SeparableStencil3D const& op, Eigen::Ref<Eigen::VectorXd> g);
+
+// Matrix-free conjugate gradients on the stored stencil, preconditioned by exact
+// solves along the z lines. Works for any coefficients, `stencil` must be symmetric
+// positive definite (DefaultMainMatrixCalculator3D gives such a stencil).
+// max_iterations == 0 means the number of unknowns.
+auto matrix_free_cg_solver(
+  Stencil7 const& stencil,
+  Eigen::Ref<Eigen::VectorXd const> g,
+  double tolerance = 1e-10,
+  size_t max_iterations = 0
+) -> Eigen::VectorXd;
+
+// Same, starting the iterations from `initial_guess` instead of zero
+auto matrix_free_cg_solver(
+  Stencil7 const& stencil,
+  Eigen::Ref<Eigen::VectorXd const> g,
+  Eigen::Ref<Eigen::VectorXd const> initial_guess,
+  double tolerance = 1e-10,
+  size_t max_iterations = 0
+) -> Eigen::VectorXd;
+
+// nested_cyclic_reduction_solver when `stencil` is separable and nx, ny are 2^m - 1,
+// matrix_free_cg_solver otherwise
+auto seven_point_solver(Stencil7 const& stencil, Eigen::Ref<Eigen::VectorXd const> g)
+  -> Eigen::VectorXd;
+
+// Computes a starting point for matrix_free_cg_solver
+using InitialGuess = std::function<Eigen::VectorXd()>;
+
+// Same, matrix_free_cg_solver starts from initial_guess(). The direct solver has no use for
+// a guess, `initial_guess` is not called at all when the stencil takes that path.
+auto seven_point_solver(
+  Stencil7 const& stencil,
+  Eigen::Ref<Eigen::VectorXd const> g,
+  InitialGuess const& initial_guess
+) -> Eigen::VectorXd;
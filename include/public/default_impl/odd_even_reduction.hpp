@@ -25,3 +25,32 @@ Eigen::VectorXd odd_even_reduction_solver(
   Eigen::VectorXd const& e,
   Eigen::VectorXd const& rhs
 );
+
+// Strided views, so a row or a column of a grid buffer is passed without a copy
+using StridedVector = Eigen::Ref<Eigen::VectorXd, 0, Eigen::InnerStride<>>;
+using ConstStridedVector = Eigen::Ref<Eigen::VectorXd const, 0, Eigen::InnerStride<>>;
+
+/// @return number of values `workspace` of odd_even_reduction_solve needs for n unknowns
+auto odd_even_reduction_workspace_size(size_t n) -> size_t;
+
+// Same system as the (a, b, c, rhs) overload, the solution overwrites `rhs`.
+// Reduced systems are kept in `workspace`, nothing is allocated; it must hold at least
+// odd_even_reduction_workspace_size(rhs.size()) values. Once a reduced system is not
+// larger than active_tuning().thomas_cutoff it is finished by the Thomas algorithm.
+void odd_even_reduction_solve(
+  ConstStridedVector a,
+  ConstStridedVector b,
+  ConstStridedVector c,
+  StridedVector rhs,
+  Eigen::Ref<Eigen::VectorXd> workspace
+);
+
+// Solves rhs.size() / length independent systems stored one after another, in place.
+// Lines are spread over threads as active_tuning() says.
+void odd_even_reduction_solve_lines(
+  Eigen::Ref<Eigen::VectorXd const> a,
+  Eigen::Ref<Eigen::VectorXd const> b,
+  Eigen::Ref<Eigen::VectorXd const> c,
+  Eigen::Ref<Eigen::VectorXd> rhs,
+  size_t length
+);
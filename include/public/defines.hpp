@@ -1,9 +1,19 @@
 #pragma once
 
 #include <functional>
+#include <span>
 
 // First argument is X, second is Y
 using X_Y_Function_type = std::function<double(double, double)>;
 
+// Arguments are X, Y, Z
+using X_Y_Z_Function_type = std::function<double(double, double, double)>;
+
 using X_Function_type = std::function<double(double)>;
 using Y_Function_type = std::function<double(double)>;
+
+// Batch forms: out[n] = f(x[n]), or f(x[n], y[n]), for a whole span in one call
+using Batch_X_Function_type = std::function<void(std::span<double const>, std::span<double>)>;
+using Batch_Y_Function_type = Batch_X_Function_type;
+using Batch_X_Y_Function_type =
+  std::function<void(std::span<double const>, std::span<double const>, std::span<double>)>;
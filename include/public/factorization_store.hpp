@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include <Eigen/Sparse>
+#include <Eigen/SparseLU>
+
+// SparseLU factors in plain compressed column form, x = P_c^{-1} U^{-1} L^{-1} P_r b.
+// The unit diagonal of L is not stored.
+struct LUFactors
+{
+  Eigen::SparseMatrix<double, Eigen::ColMajor, int> lower;
+  Eigen::SparseMatrix<double, Eigen::ColMajor, int> upper;
+  Eigen::VectorXi row_permutation;     // indices of P_r
+  Eigen::VectorXi column_permutation;  // indices of P_c
+};
+
+// Copies the supernodal factors of a factorized `solver` out of it. Supernode columns
+// hold L together with the diagonal blocks of U, the rest of U is kept aside.
+template<typename Ordering>
+auto extract_lu_factors(Eigen::SparseLU<Eigen::SparseMatrix<double>, Ordering> const& solver) -> LUFactors
+{
+  auto const& supernodes = solver.matrixL().m_mapL;
+  auto const& upper_rest = solver.matrixU().m_mapU;
+  using SupernodeIterator = typename std::decay_t<decltype(supernodes)>::InnerIterator;
+  using UpperIterator = typename std::decay_t<decltype(upper_rest)>::InnerIterator;
+
+  auto const n = solver.rows();
+  std::vector<Eigen::Triplet<double, int>> lower;
+  std::vector<Eigen::Triplet<double, int>> upper;
+  for(Eigen::Index col = 0; col < n; ++col) {
+    for(SupernodeIterator it(supernodes, col); it; ++it) {
+      auto& target = it.index() > col ? lower : upper;
+      target.emplace_back(static_cast<int>(it.index()), static_cast<int>(col), it.value());
+    }
+    for(UpperIterator it(upper_rest, col); it; ++it) {
+      upper.emplace_back(static_cast<int>(it.index()), static_cast<int>(col), it.value());
+    }
+  }
+
+  LUFactors factors {
+    Eigen::SparseMatrix<double, Eigen::ColMajor, int>(n, n),
+    Eigen::SparseMatrix<double, Eigen::ColMajor, int>(n, n),
+    solver.rowsPermutation().indices(),
+    solver.colsPermutation().indices()
+  };
+  factors.lower.setFromTriplets(lower.begin(), lower.end());
+  factors.upper.setFromTriplets(upper.begin(), upper.end());
+  return factors;
+}
+
+/// @return hash of the pattern and values of `matrix`, i.e. of the grid and the coefficients
+auto factorization_key(Eigen::SparseMatrix<double> const& matrix) -> std::uint64_t;
+
+// Binary file: a versioned header with `key`, sizes and a checksum of the payload, then
+// the permutations and both factors, every array aligned to 8 bytes. Written aside and
+// renamed, so a reader never sees a partial file.
+void save_factorization(std::filesystem::path const& path, std::uint64_t key, LUFactors const& factors);
+
+// Factors mapped from a file saved by save_factorization. Nothing is copied, the
+// file stays mapped while the object lives.
+class StoredFactorization
+{
+ public:
+  // nullopt when the file is missing, truncated, of another version or key, or its checksum
+  // does not match. Checking the checksum reads the file once.
+  static auto open(std::filesystem::path const& path, std::uint64_t key)
+    -> std::optional<StoredFactorization>;
+
+  StoredFactorization(StoredFactorization&& other) noexcept;
+  auto operator=(StoredFactorization&& other) noexcept -> StoredFactorization&;
+  StoredFactorization(StoredFactorization const&) = delete;
+  auto operator=(StoredFactorization const&) -> StoredFactorization& = delete;
+  ~StoredFactorization();
+
+  auto rows() const -> Eigen::Index { return m_rows; }
+
+  // Forward and back substitution, the solution overwrites `b`. The row permuted right side
+  // is solved in `workspace` of rows() values, so repeated solves allocate nothing.
+  void solve_in_place(Eigen::Ref<Eigen::VectorXd> b, Eigen::Ref<Eigen::VectorXd> workspace) const;
+
+  // Allocates the solution and a workspace on every call
+  auto solve(Eigen::Ref<Eigen::VectorXd const> b) const -> Eigen::VectorXd;
+
+ private:
+  using FactorView = Eigen::Map<Eigen::SparseMatrix<double, Eigen::ColMajor, int> const>;
+
+  StoredFactorization() = default;
+
+  auto lower() const -> FactorView;
+  auto upper() const -> FactorView;
+
+  void* m_mapping = nullptr;
+  size_t m_mapping_size = 0;
+
+  Eigen::Index m_rows = 0;
+  Eigen::Index m_lower_nonzeros = 0;
+  Eigen::Index m_upper_nonzeros = 0;
+
+  int const* m_row_permutation = nullptr;
+  int const* m_column_permutation = nullptr;
+  int const* m_lower_outer = nullptr;
+  int const* m_lower_inner = nullptr;
+  double const* m_lower_values = nullptr;
+  int const* m_upper_outer = nullptr;
+  int const* m_upper_inner = nullptr;
+  double const* m_upper_values = nullptr;
+};
+
+/// @return <directory>/<key in hex>.lu
+auto factorization_path(std::filesystem::path const& directory, std::uint64_t key)
+  -> std::filesystem::path;
+
+// Maps the stored factors of `matrix` from `directory`, factorizes and stores them first
+// when there are none yet
+auto load_or_factorize(Eigen::SparseMatrix<double> const& matrix, std::filesystem::path const& directory)
+  -> StoredFactorization;
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <type_traits>
+#include <vector>
+
+#include <Eigen/Sparse>
+
+// Fill reducing orderings of the unknowns of a planar grid numbered i * ny + j
+
+/// @return unknowns in the order cyclic reduction eliminates x = const lines: every other
+/// line first, then every other of the remaining ones and so on, points of a line in order
+auto cyclic_reduction_order(size_t nx, size_t ny) -> std::vector<size_t>;
+
+/// @return unknowns ordered by recursive bisection of the grid, both halves first and the
+/// separating line last
+auto nested_dissection_order(size_t nx, size_t ny) -> std::vector<size_t>;
+
+/// @return ny of a five-point matrix numbered like build_main_matrix, read from the
+/// pattern of its first column (the farthest neighbour of unknown (0, 0) is (1, 0)).
+/// A single line (nx == 1) reads as ny == 1, which numbers it the same way.
+template<typename MatrixType>
+auto deduce_grid_columns(MatrixType const& matrix) -> size_t
+{
+  Eigen::Index farthest = 1;
+  for(typename MatrixType::InnerIterator it(matrix, 0); it; ++it) {
+    farthest = std::max<Eigen::Index>(farthest, it.index());
+  }
+  return farthest;
+}
+
+/// @return whether the size of `matrix` is a multiple of ny and every stored entry couples
+/// an unknown to itself or to a grid neighbour, with unknowns numbered i * ny + j
+template<typename MatrixType>
+auto is_grid_pattern(MatrixType const& matrix, size_t ny) -> bool
+{
+  auto const columns = static_cast<size_t>(matrix.cols());
+  if(ny == 0 or static_cast<size_t>(matrix.rows()) != columns or columns % ny != 0) {
+    return false;
+  }
+
+  for(Eigen::Index column = 0; column < matrix.outerSize(); ++column) {
+    for(typename MatrixType::InnerIterator it(matrix, column); it; ++it) {
+      auto const row = static_cast<size_t>(it.index());
+      auto const distance = static_cast<size_t>(std::abs(it.index() - column));
+      bool const same_line = row / ny == static_cast<size_t>(column) / ny;
+      if(not(distance == 0 or distance == ny or (distance == 1 and same_line))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+enum class GridOrderingMethod
+{
+  cyclic_reduction,
+  nested_dissection
+};
+
+// Eigen ordering functor for matrices from build_main_matrix of planar grids.
+// SparseLU reads perm.indices()(old) == new, like COLAMDOrdering returns, while the
+// simplicial Cholesky solvers read perm.indices()(new) == old, like AMDOrdering returns,
+// so the factorization has to be named. The solvers construct the functor themselves, so
+// ny is deduced from the matrix; a matrix without the grid pattern for it (condensed or not
+// a grid at all) is ordered by COLAMD, or AMD for Cholesky, instead.
+template<typename StorageIndex, GridOrderingMethod method, bool for_cholesky>
+class GridOrdering
+{
+ public:
+  using PermutationType = Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, StorageIndex>;
+
+  template<typename MatrixType>
+  void operator()(MatrixType const& matrix, PermutationType& perm)
+  {
+    auto const size = static_cast<size_t>(matrix.cols());
+    auto const ny = size > 0 ? deduce_grid_columns(matrix) : 1;
+    if(not is_grid_pattern(matrix, ny)) {
+      std::conditional_t<for_cholesky, Eigen::AMDOrdering<StorageIndex>, Eigen::COLAMDOrdering<StorageIndex>>
+        fallback;
+      fallback(matrix, perm);
+      return;
+    }
+
+    auto const order = method == GridOrderingMethod::cyclic_reduction
+                       ? cyclic_reduction_order(size / ny, ny)
+                       : nested_dissection_order(size / ny, ny);
+
+    perm.resize(matrix.cols());
+    for(size_t position = 0; position < order.size(); ++position) {
+      if constexpr(for_cholesky) {
+        perm.indices()(position) = static_cast<StorageIndex>(order[position]);
+      }
+      else {
+        perm.indices()(order[position]) = static_cast<StorageIndex>(position);
+      }
+    }
+  }
+};
+
+template<typename StorageIndex>
+using CyclicReductionLUOrdering =
+  GridOrdering<StorageIndex, GridOrderingMethod::cyclic_reduction, false>;
+
+template<typename StorageIndex>
+using NestedDissectionLUOrdering =
+  GridOrdering<StorageIndex, GridOrderingMethod::nested_dissection, false>;
+
+template<typename StorageIndex>
+using CyclicReductionCholeskyOrdering =
+  GridOrdering<StorageIndex, GridOrderingMethod::cyclic_reduction, true>;
+
+template<typename StorageIndex>
+using NestedDissectionCholeskyOrdering =
+  GridOrdering<StorageIndex, GridOrderingMethod::nested_dissection, true>;
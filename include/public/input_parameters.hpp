@@ -2,6 +2,7 @@
 
 #include <defines.hpp>
 
+// Assembly calls the functions from several threads at once, they must be thread-safe
 struct InputParameters {
   double xl;
   double xr;
@@ -24,4 +25,33 @@ struct InputParameters {
 
   // Just input functions
   X_Y_Function_type f;
+
+  // Optional batch forms of the functions above, the grid code calls them once per
+  // boundary edge or grid row. An empty one falls back to its scalar function.
+  Batch_Y_Function_type u1_batch;
+  Batch_Y_Function_type u2_batch;
+  Batch_X_Function_type u3_batch;
+  Batch_X_Function_type u4_batch;
+  Batch_X_Y_Function_type f_batch;
+};
+
+// Box [xl, xr] x [yl, yr] x [zl, zr] with -div(k grad u) = f inside
+// and first type condition u = u0 on every face. Assembly calls u0, k and f from several
+// threads at once, they must be thread-safe.
+struct InputParameters3D {
+  double xl;
+  double xr;
+  double yl;
+  double yr;
+  double zl;
+  double zr;
+
+  // First type condition on all six faces
+  X_Y_Z_Function_type u0;
+
+  // Diffusion coefficient
+  X_Y_Z_Function_type k;
+
+  // Just input functions
+  X_Y_Z_Function_type f;
 };
@@ -8,6 +8,8 @@ struct Index
 {
   size_t i = -1;
   size_t j = -1;
+  // Planar calculators have a single layer in z
+  size_t k = 0;
 };
 
 class IMainMatrixCalculator
@@ -20,9 +22,49 @@ class IMainMatrixCalculator
   virtual auto calc_e(Index index) const -> double = 0;
   virtual auto calc_g(Index index) const -> double = 0;
 
+  // calc_g of the unknowns on boundary edges of the whole grid, called once before
+  // calc_g_planes so that every edge function is evaluated by a single batch call.
+  // calc_g_planes leaves the values written here alone.
+  virtual void calc_g_edges(std::span<double> /*g*/) const {}
+
+  // calc_g of the unknowns in the x planes begin..end - 1, numbered (i * ny + j) * nz + k
+  // from the first of them, except those calc_g_edges writes. Calculators override it to
+  // evaluate the input functions once per grid row instead of once per point. Assembly
+  // calls it for disjoint ranges from several threads.
+  virtual void calc_g_planes(size_t begin, size_t end, std::span<double> g) const
+  {
+    auto const ny = interiour_y_points().size();
+    auto const nz = z_points().empty() ? 1 : interiour_z_points().size();
+    for(size_t i = begin; i < end; ++i) {
+      for(size_t j = 0; j < ny; ++j) {
+        for(size_t k = 0; k < nz; ++k) {
+          g[((i - begin) * ny + j) * nz + k] = calc_g({i, j, k});
+        }
+      }
+    }
+  }
+
+  // Coefficients of the (i, j, k - 1) and (i, j, k + 1) neighbours
+  virtual auto calc_p(Index /*index*/) const -> double { return 0; }
+  virtual auto calc_q(Index /*index*/) const -> double { return 0; }
+
+  // Rows of first type condition unknowns, which are identity rows with the
+  // boundary value in g
+  virtual auto is_first_type(Index /*index*/) const -> bool { return false; }
+
   virtual auto x_points() const -> std::vector<double> const& = 0;
   virtual auto y_points() const -> std::vector<double> const& = 0;
 
+  // Empty for planar calculators
+  virtual auto z_points() const -> std::vector<double> const&
+  {
+    static std::vector<double> const no_points;
+    return no_points;
+  }
+
   virtual auto interiour_x_points() const -> std::span<const double> = 0;
   virtual auto interiour_y_points() const -> std::span<const double> = 0;
+
+  // Empty for planar calculators
+  virtual auto interiour_z_points() const -> std::span<const double> { return {}; }
 };
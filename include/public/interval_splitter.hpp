@@ -10,6 +10,50 @@
 
 auto split_interval(const double& left, const double& right, size_t num_intervals) -> std::vector<double>;
 
+// End(s) of the interval the graded splits below refine
+enum class GradedEnd
+{
+  left,
+  right,
+  both,
+};
+
+// Every interval is `ratio` times longer than its neighbour towards `end`, so the shortest
+// ones are at `end` (in the middle for both). ratio == 1 gives split_interval.
+auto split_interval_geometric(
+  const double& left,
+  const double& right,
+  size_t num_intervals,
+  double ratio,
+  GradedEnd end = GradedEnd::right
+) -> std::vector<double>;
+
+// Chebyshev-Gauss-Lobatto points, refined at both ends: the end intervals are about
+// pi^2 / (4 n^2) of the length instead of 1 / n
+auto split_interval_chebyshev(const double& left, const double& right, size_t num_intervals)
+  -> std::vector<double>;
+
+// Uniform s = i / n mapped through tanh(beta * s) / tanh(beta) towards `end` (mirrored for the
+// left end, on [-1, 1] for both). The end intervals shrink about sinh(2 beta) / (2 beta) times
+// relative to split_interval, and the spacing varies smoothly, beta > 0.
+auto split_interval_tanh(
+  const double& left,
+  const double& right,
+  size_t num_intervals,
+  double beta,
+  GradedEnd end = GradedEnd::right
+) -> std::vector<double>;
+
+// Interpolation error estimate h^2 |u''| / 8 of every interval of `points`, u'' of `values`
+// (one per point) by the three-point formula at the inner points. Entry m is for the interval
+// from point m to point m + 1 and takes the larger second derivative of its ends.
+auto curvature_indicator(std::span<const double> points, std::span<const double> values)
+  -> std::vector<double>;
+
+// `points` with the midpoint added to every interval m whose indicator[m] exceeds `threshold`
+auto refine_marked(std::span<const double> points, std::span<const double> indicator, double threshold)
+  -> std::vector<double>;
+
 // Calculate the length of an interval `index-1` to `index`
 auto calc_h(std::span<const double> intervals, size_t index) -> double;
 
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include <interface/i_main_matrix_calculator.hpp>
+
+// Numbers of interior unknowns along each axis, planar grids have nz == 1.
+// Unknown (i, j, k) has the number (i * ny + j) * nz + k, so every x = const plane
+// and every line along z is contiguous.
+struct GridShape
+{
+  size_t nx = 0;
+  size_t ny = 0;
+  size_t nz = 1;
+
+  auto size() const -> size_t { return nx * ny * nz; }
+
+  auto index(Index index) const -> size_t { return (index.i * ny + index.j) * nz + index.k; }
+};
+
+auto grid_shape(IMainMatrixCalculator const& calc) -> GridShape;
+
+// Seven-point stencil kept as one coefficient per unknown and direction, named after
+// the IMainMatrixCalculator accessors. Couplings leaving the grid are stored as zero.
+struct Stencil7
+{
+  GridShape shape;
+
+  Eigen::VectorXd a;  // (i, j - 1, k)
+  Eigen::VectorXd b;  // (i, j + 1, k)
+  Eigen::VectorXd c;  // (i, j, k)
+  Eigen::VectorXd d;  // (i - 1, j, k)
+  Eigen::VectorXd e;  // (i + 1, j, k)
+  Eigen::VectorXd p;  // (i, j, k - 1)
+  Eigen::VectorXd q;  // (i, j, k + 1)
+};
+
+// Assembly splits the grid into blocks of x planes over active_tuning().assembly_threads
+// threads, the calculator is called from all of them at once, so it and the input functions
+// behind it must be thread-safe. Every block writes its own columns of the matrix (rows of g)
+// in place, nothing is merged or sorted afterwards.
+auto build_main_matrix(IMainMatrixCalculator const& calc) -> Eigen::SparseMatrix<double>;
+
+auto build_g_vector(IMainMatrixCalculator const& calc) -> Eigen::VectorXd;
+
+auto build_stencil(IMainMatrixCalculator const& calc) -> Stencil7;
+
+/// @return stencil * w without forming the matrix
+auto apply_stencil(Stencil7 const& stencil, Eigen::VectorXd const& w) -> Eigen::VectorXd;
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <boundary_condensation.hpp>
+#include <default_impl/main_matrix_calculator.hpp>
+
+// Solution on the whole grid: Nx x Ny interior values surrounded by one layer of
+// boundary values. Storage is row-major, so the interior of every x = const row is
+// contiguous and matches the i * Ny + j numbering of the unknowns.
+class PaddedGrid
+{
+ public:
+  using RowMajorMatrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+  using InteriorView = Eigen::Map<RowMajorMatrix, Eigen::Unaligned, Eigen::OuterStride<>>;
+
+  PaddedGrid(size_t nx, size_t ny)
+    : m_nx(nx)
+    , m_ny(ny)
+    , m_values((nx + 2) * (ny + 2), 0)
+  {}
+
+  auto nx() const -> size_t { return m_nx; }
+
+  auto ny() const -> size_t { return m_ny; }
+
+  // (Nx + 2) x (Ny + 2), boundary included
+  auto full() -> Eigen::Map<RowMajorMatrix> { return {m_values.data(), rows(), cols()}; }
+
+  auto full() const -> Eigen::Map<RowMajorMatrix const>
+  {
+    return {m_values.data(), rows(), cols()};
+  }
+
+  // Nx x Ny view, element (i, j) is the unknown i * Ny + j
+  auto interior() -> InteriorView
+  {
+    return {
+      m_values.data() + cols() + 1,
+      static_cast<Eigen::Index>(m_nx),
+      static_cast<Eigen::Index>(m_ny),
+      Eigen::OuterStride<>(cols())
+    };
+  }
+
+  auto interior_row(size_t i) -> Eigen::Map<Eigen::VectorXd>
+  {
+    return {m_values.data() + (i + 1) * cols() + 1, static_cast<Eigen::Index>(m_ny)};
+  }
+
+ private:
+  auto rows() const -> Eigen::Index { return static_cast<Eigen::Index>(m_nx + 2); }
+
+  auto cols() const -> Eigen::Index { return static_cast<Eigen::Index>(m_ny + 2); }
+
+  size_t m_nx;
+  size_t m_ny;
+  std::vector<double> m_values;
+};
+
+// Boundary functions sampled once per grid, u1 and u2 over y_points, u3 and u4 over x_points
+struct BoundarySamples
+{
+  Eigen::VectorXd u1;
+  Eigen::VectorXd u2;
+  Eigen::VectorXd u3;
+  Eigen::VectorXd u4;
+};
+
+auto sample_boundary(DefaultMainMatrixCalculator const& calc) -> BoundarySamples;
+
+// Copies whole edges from `samples`, corners take u3 and u4 values
+void fill_boundary(BoundarySamples const& samples, PaddedGrid& grid);
+
+// Writes the kept unknowns from `w` and the eliminated ones from their boundary values
+// straight into the interior of `grid`, unknown n at row n / Ny, column n % Ny. Runs of
+// consecutive unknowns within a row are copied as whole segments.
+void store_condensed(CondensedSystem const& system, Eigen::Ref<Eigen::VectorXd const> w, PaddedGrid& grid);
+
+// The solution overwrites `system.g` (SparseLU needs a contiguous destination) and is then
+// scattered into the interior of `grid`, no full size buffer is allocated
+template<typename Solver>
+void solve_into(Solver const& solver, CondensedSystem& system, PaddedGrid& grid)
+{
+  system.g = solver.solve(system.g);
+  store_condensed(system, system.g, grid);
+}
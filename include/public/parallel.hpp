@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+// Calls body(begin, end) for consecutive ranges of at most `batch` items out of `count`,
+// spread over `threads` threads (the calling one included). The other threads are kept in a
+// pool between calls. A call made while another one runs (from a body or from another
+// thread), or with a single batch, runs inline on the calling thread.
+void parallel_for(
+  size_t count,
+  size_t batch,
+  size_t threads,
+  std::function<void(size_t begin, size_t end)> const& body
+);
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <interface/i_main_matrix_calculator.hpp>
+#include <matrix_builder.hpp>
+
+enum class SolverKind
+{
+  sparse_lu,                // Eigen::SparseLU on build_main_matrix
+  block_thomas,             // block_thomas_solver, blocks of ny * nz
+  nested_cyclic_reduction,  // nested_cyclic_reduction_solver, separable stencils only
+  matrix_free_cg,           // matrix_free_cg_solver, symmetric positive definite stencils only
+};
+
+inline constexpr std::array all_solvers = {
+  SolverKind::sparse_lu,
+  SolverKind::block_thomas,
+  SolverKind::nested_cyclic_reduction,
+  SolverKind::matrix_free_cg,
+};
+
+auto solver_name(SolverKind solver) -> std::string;
+
+/// @return nullopt for an unknown name
+auto parse_solver(std::string const& name) -> std::optional<SolverKind>;
+
+// What is known about the coefficients of the system
+struct ProblemTraits
+{
+  bool separable = false;                    // extract_separable_stencil would succeed
+  bool symmetric_positive_definite = false;  // DefaultMainMatrixCalculator3D gives such systems
+};
+
+// separable when extract_separable_stencil succeeds. Symmetric positive definite is decided by
+// a sufficient test: symmetric couplings, positive diagonal, diagonal dominance in every row
+// and strict dominance in at least one (irreducible diagonal dominance).
+auto problem_traits(Stencil7 const& stencil) -> ProblemTraits;
+
+// Bytes held at the peak of a solve
+struct MemoryEstimate
+{
+  size_t matrix = 0;     // assembled matrix or stencil
+  size_t factors = 0;    // LU factors, reduced blocks
+  size_t workspace = 0;  // copies and scratch vectors of the solver
+  size_t output = 0;     // g and the solution
+
+  auto total() const -> size_t { return matrix + factors + workspace + output; }
+};
+
+// Every solver's model gives its work in units (e.g. nx * K^3 for block Thomas) and its peak
+// memory in bytes, these scale them to the host
+struct KernelCost
+{
+  double seconds_per_unit = 0;
+  double memory_scale = 1;
+};
+
+struct CostModel
+{
+  std::array<KernelCost, all_solvers.size()> kernels;
+
+  // LU factor entries per n log2(n) on planar grids, per n b on volumes (b: smallest
+  // cross-section of the grid)
+  double lu_fill = 0;
+  double lu_volume_fill = 0;
+
+  // LU work per n b^1.5 on volumes, relative to the planar unit n^1.5
+  double lu_volume_work = 1;
+
+  auto operator[](SolverKind solver) const -> KernelCost const& { return kernels[size_t(solver)]; }
+  auto operator[](SolverKind solver) -> KernelCost& { return kernels[size_t(solver)]; }
+};
+
+// Costs measured on one core of a small Linux host, see calibrate() to fit them to this one
+auto default_cost_model() -> CostModel;
+
+// default_cost_model() calibrated by the outcomes logged at default_plan_log_path(),
+// loaded on first use
+auto active_cost_model() -> CostModel const&;
+
+/// @return $COURSE_PLAN_LOG, or ~/.cache/course/plans.txt
+auto default_plan_log_path() -> std::filesystem::path;
+
+/// @return false when `solver` can not solve such a system at all
+auto applicable(SolverKind solver, GridShape const& shape, ProblemTraits const& traits) -> bool;
+
+struct SolveEstimate
+{
+  SolverKind solver;
+  MemoryEstimate memory;
+  double seconds = 0;
+};
+
+auto estimate_solve(SolverKind solver, GridShape const& shape, CostModel const& model = active_cost_model())
+  -> SolveEstimate;
+
+// Why plan_solve chose the solver of a plan
+enum class PlanReason
+{
+  preferred,       // `preferred` is applicable and fits into the limit
+  not_applicable,  // `preferred` can not solve such a system
+  downgraded       // `preferred` is applicable but does not fit into the limit
+};
+
+struct SolvePlan
+{
+  SolveEstimate estimate;
+  PlanReason reason = PlanReason::preferred;
+};
+
+// `preferred` when it is applicable and fits into `memory_limit` bytes, otherwise the fastest
+// applicable solver that fits. nullopt when none does: the solve should not be started.
+auto plan_solve(
+  GridShape const& shape,
+  ProblemTraits const& traits,
+  SolverKind preferred,
+  size_t memory_limit,
+  CostModel const& model = active_cost_model()
+) -> std::optional<SolvePlan>;
+
+/// @return MemAvailable of /proc/meminfo, or the room left under the cgroup limit when smaller
+auto available_memory() -> size_t;
+
+/// @return VmHWM of /proc/self/status, the peak resident size of this process so far
+auto peak_resident_memory() -> size_t;
+
+/// @return VmRSS of /proc/self/status
+auto resident_memory() -> size_t;
+
+// Predicted and measured cost of one solve
+struct PlanOutcome
+{
+  SolverKind solver;
+  GridShape shape;
+  size_t predicted_bytes = 0;
+  double predicted_seconds = 0;
+  size_t actual_bytes = 0;
+  double actual_seconds = 0;
+};
+
+// One line per outcome: "<solver> <nx> <ny> <nz> <predicted bytes> <predicted seconds>
+// <actual bytes> <actual seconds>", appended
+void record_outcome(std::filesystem::path const& path, PlanOutcome const& outcome);
+
+auto load_outcomes(std::filesystem::path const& path) -> std::vector<PlanOutcome>;
+
+// Scales the time and memory of every solver by the median of actual / predicted over its
+// outcomes, solvers without outcomes keep their costs
+auto calibrate(std::span<PlanOutcome const> outcomes, CostModel model) -> CostModel;
+
+struct PlannedSolution
+{
+  Eigen::VectorXd w;
+  PlanOutcome outcome;
+};
+
+// Assembles the system of `calc` and solves it with the planned solver. The outcome holds
+// the solve time and the growth of the resident size over assembly and solve.
+auto execute_plan(SolvePlan const& plan, IMainMatrixCalculator const& calc) -> PlannedSolution;
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+
+/// @return std::thread::hardware_concurrency(), at least 1
+auto default_assembly_threads() -> size_t;
+
+// Machine dependent parameters of the solver kernels
+struct SolverTuning
+{
+  // odd_even_reduction_solve hands systems of at most this size to the Thomas algorithm
+  size_t thomas_cutoff = 1;
+
+  // Independent line solves are split into tasks of `line_batch` lines over `threads` threads
+  size_t line_batch = 64;
+  size_t threads = 1;
+
+  // Matrix, g and stencil assembly spread blocks of planes over this many threads. It is not
+  // swept by autotune nor kept in the tuning file, assembly scales with every core.
+  size_t assembly_threads = default_assembly_threads();
+};
+
+// Tuning the solvers use. On first use it is loaded from default_tuning_path() for
+// cpu_model(), defaults are used when there is no entry.
+auto active_tuning() -> SolverTuning const&;
+
+// Not synchronized with running solves, call it before they start
+void set_active_tuning(SolverTuning tuning);
+
+/// @return "model name" of /proc/cpuinfo, "unknown" when it is not available
+auto cpu_model() -> std::string;
+
+/// @return $COURSE_TUNING_FILE, or ~/.cache/course/tuning.txt
+auto default_tuning_path() -> std::filesystem::path;
+
+// The file keeps one line per CPU model: "<model>\t<thomas_cutoff> <line_batch> <threads>"
+auto load_tuning(std::filesystem::path const& path, std::string const& cpu)
+  -> std::optional<SolverTuning>;
+
+// Replaces the entry of `cpu`, entries of other models are kept
+void save_tuning(
+  std::filesystem::path const& path,
+  std::string const& cpu,
+  SolverTuning const& tuning
+);
+
+// Times the kernels on this host for every system size in `sizes` and returns the fastest
+// parameters. The active tuning is left unchanged.
+auto autotune(std::span<size_t const> sizes) -> SolverTuning;
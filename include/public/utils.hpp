@@ -1,6 +1,9 @@
 #pragma once
 
 #include <memory>
+#include <span>
+#include <string>
+#include <vector>
 
 #include <defines.hpp>
 #include <input_parameters.hpp>
@@ -10,4 +13,35 @@ void do_all1(std::shared_ptr<InputParameters> params, X_Y_Function_type expected
 void do_all2(std::shared_ptr<InputParameters> params, X_Y_Function_type expected_func);
 void do_all3(std::shared_ptr<InputParameters> params, X_Y_Function_type expected_func);
 void do_all4(std::shared_ptr<InputParameters> params, X_Y_Function_type expected_func);
-void do_all5(std::shared_ptr<InputParameters> params, X_Y_Function_type expected_func);
\ No newline at end of file
+void do_all5(std::shared_ptr<InputParameters> params, X_Y_Function_type expected_func);
+
+struct ConvergenceRow
+{
+  size_t intervals;
+  size_t unknowns;
+  double inaccuracy;  // max |w - expected| over the interior points
+  double seconds;     // solve time, assembly excluded
+};
+
+// Solves the box with every count of intervals along all three axes
+auto run_box_convergence(
+  std::shared_ptr<InputParameters3D> params,
+  X_Y_Z_Function_type expected_func,
+  std::span<size_t const> interval_counts
+) -> std::vector<ConvergenceRow>;
+
+struct OrderingComparisonRow
+{
+  size_t intervals;
+  std::string factorization;
+  std::string ordering;
+  size_t factor_nonzeros;  // nnz(L) + nnz(U) for LU, nnz(L) for LDLT
+  double seconds;          // analyzePattern and factorize together
+  bool factorized = true;  // false when the factorization ran out of memory
+};
+
+// Factorizes the five-point Laplacian on a square grid with every interval count, under
+// COLAMD/AMD, cyclic reduction and nested dissection orderings. Cyclic reduction fills whole
+// blocks between lines, it is skipped on grids where that would not fit in memory. Other
+// factorizations that run out of memory are reported without factor size and time.
+auto compare_orderings(std::span<size_t const> interval_counts) -> std::vector<OrderingComparisonRow>;
@@ -1,8 +1,17 @@
 import numpy as np
 
+# Extension module built with -DCOURSE_PYTHON_BINDINGS=ON
+import course
 
-def solve_matrix_equation(A, B):
-    return np.linalg.solve(A, B)
+
+def solve_matrix_equation(shape, a, b, c, d, e, p, q, B):
+    """
+    Solves the seven-point system given by its coefficient arrays.
+    Arrays are passed to the solver without copying, the solution is returned
+    as a course.Vector which numpy views without copying either.
+    """
+    stencil = course.stencil(shape, a, b, c, d, e, p, q)
+    return np.asarray(course.solve(stencil, B))
 
 
 def example_usage():
@@ -10,56 +19,80 @@ def example_usage():
     Example of usage of the function solve_matrix_equation.
     """
 
-    # Define the matrix equation
-    A = np.array(
-        [
-            [5, 1, 0, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0],
-            [1, 5, 1, 0, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0],
-            [0, 1, 5, 0, 0, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0],
-            [-1, 0, 0, 5, 1, 0, -1, 0, 0, 0, 0, 0, 0, 0, 0],
-            [0, -1, 0, 1, 5, 1, 0, -1, 0, 0, 0, 0, 0, 0, 0],
-            [0, 0, -1, 0, 1, 5, 0, 0, -1, 0, 0, 0, 0, 0, 0],
-            [0, 0, 0, -1, 0, 0, 5, 1, 0, -1, 0, 0, 0, 0, 0],
-            [0, 0, 0, 0, -1, 0, 1, 5, 1, 0, -1, 0, 0, 0, 0],
-            [0, 0, 0, 0, 0, -1, 0, 1, 5, 0, 0, -1, 0, 0, 0],
-            [0, 0, 0, 0, 0, 0, -1, 0, 0, 5, 1, 0, -1, 0, 0],
-            [0, 0, 0, 0, 0, 0, 0, -1, 0, 1, 5, 1, 0, -1, 0],
-            [0, 0, 0, 0, 0, 0, 0, 0, -1, 0, 1, 5, 0, 0, -1],
-            [0, 0, 0, 0, 0, 0, 0, 0, 0, -1, 0, 0, 5, 1, 0],
-            [0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -1, 0, 1, 5, 1],
-            [0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -1, 0, 1, 5],
-        ]
-    )
-    B = np.array([1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15])
+    # 5 lines of 3 points: 5 on the diagonal, 1 between neighbours on a line,
+    # -1 between neighbouring lines
+    shape = (5, 1, 3)
+    n = 15
+
+    index = np.arange(n)
+    k = index % shape[2]
+    i = index // shape[2]
+
+    c = np.full(n, 5.0)
+    p = np.where(k > 0, 1.0, 0.0)
+    q = np.where(k < shape[2] - 1, 1.0, 0.0)
+    d = np.where(i > 0, -1.0, 0.0)
+    e = np.where(i < shape[0] - 1, -1.0, 0.0)
+    a = np.zeros(n)
+    b = np.zeros(n)
+
+    B = np.arange(1, n + 1, dtype=np.float64)
 
     # Solve the matrix equation
-    X = solve_matrix_equation(A, B)
+    X = solve_matrix_equation(shape, a, b, c, d, e, p, q, B)
 
     # Print the solution
     print("Solution is X = ")
     for elem in X:
         print(elem)
 
+    # Residual of every equation
+    residual = c * X - B
+    residual[1:] += p[1:] * X[:-1]
+    residual[:-1] += q[:-1] * X[1:]
+    residual[shape[2]:] += d[shape[2]:] * X[:-shape[2]]
+    residual[:-shape[2]] += e[:-shape[2]] * X[shape[2]:]
+
     print("Inaccuracy is ")
-    for elem in [np.finfo(float).eps] * len(X):
+    for elem in np.abs(residual):
         print(elem)
 
 
-if __name__ == "__main__":
-    example_usage()
+def tridiagonal_usage():
+    """
+    Odd-even reduction on a column of a 2D grid, solved in place.
+    """
+    grid = np.zeros((7, 4))
+    grid[:, 2] = np.arange(1, 8)
+
+    n = grid.shape[0]
+    course.tridiagonal_solve(np.ones(n), np.full(n, 4.0), np.ones(n), grid[:, 2])
+    print("Column solution is ", grid[:, 2])
+
+
+def convergence_usage():
+    """
+    Maximal inaccuracy of the 3D box solution against a known one.
+    """
+
+    def expected(x, y, z):
+        return x * x + y * y - 2 * z * z
 
-# Define parameters
-n = 15  # Matrix size
-eps = np.finfo(float).eps  # Machine epsilon for double precision (≈ 2.22e-16)
-kappa_A = 10  # Assumed well-conditioned matrix (adjustable)
+    rows = course.run_convergence(
+        (0, 1, 0, 1, 0, 2),
+        expected,
+        lambda x, y, z: 1.0,
+        lambda x, y, z: 0.0,
+        expected,
+        [8, 16, 32],
+    )
 
-# Compute base error magnitude
-base_error = kappa_A * n * eps  # Theoretical upper bound of inaccuracy
+    print("intervals unknowns inaccuracy seconds")
+    for row in rows:
+        print(*row)
 
-# Generate the inaccuracy vector with slight random variation
-inaccuracy_vector = base_error * (1 + 0.01 * np.random.randn(n))  # 10% noise
 
-# Print result
-print("Inaccuracy is:")
-for x in inaccuracy_vector:
-    print(x)
+if __name__ == "__main__":
+    example_usage()
+    tridiagonal_usage()
+    convergence_usage()
@@ -0,0 +1,379 @@
+#include <adaptive_refinement.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include <contract/contract.hpp>
+
+#include <default_impl/main_matrix_calculator_3d.hpp>
+#include <default_impl/nested_cyclic_reduction.hpp>
+#include <interval_splitter.hpp>
+#include <matrix_builder.hpp>
+
+namespace
+{
+  // Grid point (i, j, k) of a grid with n intervals along every axis
+  auto point_index(size_t n, size_t i, size_t j, size_t k) -> size_t
+  {
+    return (i * (n + 1) + j) * (n + 1) + k;
+  }
+
+  // Interior solution surrounded by the boundary values, one per grid point numbered
+  // (i * y_points + j) * z_points + k
+  auto with_boundary(DefaultMainMatrixCalculator3D const& calc, Eigen::VectorXd const& w)
+    -> std::vector<double>
+  {
+    auto const& x = calc.x_points();
+    auto const& y = calc.y_points();
+    auto const& z = calc.z_points();
+    auto const& u0 = calc.params()->u0;
+    auto const nx = x.size() - 1;
+    auto const ny = y.size() - 1;
+    auto const nz = z.size() - 1;
+
+    std::vector<double> values(x.size() * y.size() * z.size());
+    for(size_t i = 0; i <= nx; ++i) {
+      for(size_t j = 0; j <= ny; ++j) {
+        for(size_t k = 0; k <= nz; ++k) {
+          auto const interior = i > 0 and i < nx and j > 0 and j < ny and k > 0 and k < nz;
+          values[(i * y.size() + j) * z.size() + k] =
+            interior ? w(((i - 1) * (ny - 1) + (j - 1)) * (nz - 1) + (k - 1)) : u0(x[i], y[j], z[k]);
+        }
+      }
+    }
+    return values;
+  }
+
+  // Trilinear interpolation of the coarse grid values to the interior of the grid with twice
+  // as many intervals. A fine point lies either on a coarse point or halfway between two of
+  // them along every axis, so it is the mean of the (up to 8 distinct) surrounding coarse values.
+  auto prolongate(std::vector<double> const& coarse, size_t coarse_n) -> Eigen::VectorXd
+  {
+    auto const n = 2 * coarse_n;
+    Eigen::VectorXd fine((n - 1) * (n - 1) * (n - 1));
+
+    size_t row = 0;
+    for(size_t i = 1; i < n; ++i) {
+      for(size_t j = 1; j < n; ++j) {
+        for(size_t k = 1; k < n; ++k) {
+          double sum = 0;
+          for(auto const ci : {i / 2, (i + 1) / 2}) {
+            for(auto const cj : {j / 2, (j + 1) / 2}) {
+              for(auto const ck : {k / 2, (k + 1) / 2}) {
+                sum += coarse[point_index(coarse_n, ci, cj, ck)];
+              }
+            }
+          }
+          fine(row++) = sum / 8;
+        }
+      }
+    }
+    return fine;
+  }
+
+  using Axes = std::array<std::vector<double>, 3>;
+
+  // curvature_indicator of every interval along `axis`, the largest over all grid lines
+  auto axis_indicator(Axes const& points, std::vector<double> const& values, size_t axis)
+    -> std::vector<double>
+  {
+    std::array<size_t, 3> const sizes = {points[0].size(), points[1].size(), points[2].size()};
+    std::array<size_t, 3> const strides = {sizes[1] * sizes[2], sizes[2], 1};
+    auto const& along = points[axis];
+
+    // One line starts at every point with index 0 along `axis`
+    auto starts = sizes;
+    starts[axis] = 1;
+
+    std::vector<double> indicator(along.size() - 1, 0);
+    std::vector<double> line(along.size());
+    for(size_t i = 0; i < starts[0]; ++i) {
+      for(size_t j = 0; j < starts[1]; ++j) {
+        for(size_t k = 0; k < starts[2]; ++k) {
+          auto const start = i * strides[0] + j * strides[1] + k * strides[2];
+          for(size_t m = 0; m < line.size(); ++m) {
+            line[m] = values[start + m * strides[axis]];
+          }
+          auto const estimate = curvature_indicator(along, line);
+          for(size_t m = 0; m < indicator.size(); ++m) {
+            indicator[m] = std::max(indicator[m], estimate[m]);
+          }
+        }
+      }
+    }
+    return indicator;
+  }
+
+  // Trilinear interpolation of `values` on the grid `from` to the interior points of `to`,
+  // both grids span the same box
+  auto interpolate(Axes const& from, std::vector<double> const& values, Axes const& to) -> Eigen::VectorXd
+  {
+    // Interval of `from` every interior point of `to` falls into, and its weight on the right end
+    std::array<std::vector<size_t>, 3> lower;
+    std::array<std::vector<double>, 3> weight;
+    for(size_t axis = 0; axis < 3; ++axis) {
+      auto const& coarse = from[axis];
+      for(size_t p = 1; p + 1 < to[axis].size(); ++p) {
+        auto const x = to[axis][p];
+        auto const right = std::upper_bound(coarse.begin(), coarse.end() - 1, x) - coarse.begin();
+        auto const left = static_cast<size_t>(right - 1);
+        lower[axis].push_back(left);
+        weight[axis].push_back((x - coarse[left]) / (coarse[left + 1] - coarse[left]));
+      }
+    }
+
+    auto const ny = from[1].size();
+    auto const nz = from[2].size();
+    Eigen::VectorXd result(lower[0].size() * lower[1].size() * lower[2].size());
+
+    size_t row = 0;
+    for(size_t i = 0; i < lower[0].size(); ++i) {
+      for(size_t j = 0; j < lower[1].size(); ++j) {
+        for(size_t k = 0; k < lower[2].size(); ++k) {
+          double sum = 0;
+          for(size_t corner = 0; corner < 8; ++corner) {
+            auto const di = corner >> 2;
+            auto const dj = (corner >> 1) & 1;
+            auto const dk = corner & 1;
+            auto const w = (di ? weight[0][i] : 1 - weight[0][i]) * (dj ? weight[1][j] : 1 - weight[1][j])
+                         * (dk ? weight[2][k] : 1 - weight[2][k]);
+            sum += w * values[((lower[0][i] + di) * ny + lower[1][j] + dj) * nz + lower[2][k] + dk];
+          }
+          result(row++) = sum;
+        }
+      }
+    }
+    return result;
+  }
+
+  // Every other point of `points` and the last one. An axis with fewer than 4 intervals is kept
+  // as it is, so that the coarse grid still has interior points along it.
+  auto coarsen(std::vector<double> const& points) -> std::vector<double>
+  {
+    if(points.size() < 5) {
+      return points;
+    }
+
+    std::vector<double> coarse;
+    for(size_t m = 0; m < points.size(); m += 2) {
+      coarse.push_back(points[m]);
+    }
+    if(coarse.back() != points.back()) {
+      coarse.push_back(points.back());
+    }
+    return coarse;
+  }
+
+  // Fine solution at the interior points of the coarse grid `coarse`, the fine grid has every
+  // interval of it bisected
+  auto restrict_to_coarse(Eigen::VectorXd const& fine, GridShape const& coarse) -> Eigen::VectorXd
+  {
+    auto const fine_ny = 2 * coarse.ny + 1;
+    auto const fine_nz = 2 * coarse.nz + 1;
+    Eigen::VectorXd result(coarse.size());
+
+    size_t row = 0;
+    for(size_t i = 0; i < coarse.nx; ++i) {
+      for(size_t j = 0; j < coarse.ny; ++j) {
+        for(size_t k = 0; k < coarse.nz; ++k) {
+          result(row++) = fine(((2 * i + 1) * fine_ny + 2 * j + 1) * fine_nz + 2 * k + 1);
+        }
+      }
+    }
+    return result;
+  }
+}  // namespace
+
+auto solve_to_tolerance(
+  std::shared_ptr<InputParameters3D> params,
+  double tolerance,
+  size_t initial_intervals,
+  size_t max_intervals
+) -> AdaptiveSolution
+{
+  // clang-format off
+  contract(fun) {
+    precondition(tolerance > 0, "tolerance must be positive");
+    precondition(initial_intervals >= 2, "at least one interior point is required");
+    precondition(initial_intervals <= max_intervals, "initial grid exceeds max_intervals");
+  };
+  // clang-format on
+
+  constexpr double nominal_order = 2;
+
+  AdaptiveSolution result{};
+  result.error_estimate = std::numeric_limits<double>::infinity();
+
+  std::vector<double> coarse_values;
+  Eigen::VectorXd coarse_solution;
+  double previous_difference = 0;
+
+  for(size_t n = initial_intervals; n <= max_intervals; n *= 2) {
+    auto start = std::chrono::steady_clock::now();
+
+    DefaultMainMatrixCalculator3D calc(
+      params,
+      split_interval(params->xl, params->xr, n),
+      split_interval(params->yl, params->yr, n),
+      split_interval(params->zl, params->zr, n)
+    );
+    auto stencil = build_stencil(calc);
+    auto g_vector = build_g_vector(calc);
+
+    Eigen::VectorXd solution = coarse_values.empty()
+                                 ? seven_point_solver(stencil, g_vector)
+                                 : seven_point_solver(stencil, g_vector, [&] { return prolongate(coarse_values, n / 2); });
+
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    RefinementLevel level{n, stencil.shape.size(), std::numeric_limits<double>::infinity(), nominal_order, 0};
+
+    if(not coarse_values.empty()) {
+      Eigen::VectorXd const on_coarse = restrict_to_coarse(solution, {n / 2 - 1, n / 2 - 1, n / 2 - 1});
+      Eigen::VectorXd const difference = on_coarse - coarse_solution;
+      auto const difference_norm = difference.lpNorm<Eigen::Infinity>();
+
+      if(previous_difference > 0 and difference_norm > 0) {
+        auto const observed = std::log2(previous_difference / difference_norm);
+        if(observed >= 1 and observed <= 4) {
+          level.order = observed;
+        }
+      }
+
+      auto const factor = 1 / (std::pow(2.0, level.order) - 1);
+      level.error_estimate = factor * difference_norm;
+      result.solution = on_coarse + factor * difference;
+      result.intervals = n / 2;
+      previous_difference = difference_norm;
+    }
+    else {
+      result.solution = solution;
+      result.intervals = n;
+    }
+
+    level.seconds = elapsed.count();
+    result.levels.push_back(level);
+    result.error_estimate = level.error_estimate;
+
+    if(level.error_estimate <= tolerance) {
+      result.converged = true;
+      return result;
+    }
+
+    coarse_values = with_boundary(calc, solution);
+    coarse_solution = std::move(solution);
+  }
+
+  result.converged = false;
+  return result;
+}
+
+auto refine_to_indicator(
+  std::shared_ptr<InputParameters3D> params,
+  std::vector<double> x_points,
+  std::vector<double> y_points,
+  std::vector<double> z_points,
+  double tolerance,
+  size_t max_unknowns
+) -> GradedSolution
+{
+  // clang-format off
+  contract(fun) {
+    precondition(tolerance > 0, "tolerance must be positive");
+    precondition(x_points.size() >= 3 and y_points.size() >= 3 and z_points.size() >= 3,
+                 "at least one interior point is required");
+  };
+  // clang-format on
+
+  constexpr double marking_fraction = 0.5;
+  // Merging pairs of intervals multiplies the error of the second order scheme by 4, so the
+  // error on the grid is a third of its difference from the coarsened grid's one
+  constexpr double richardson_factor = 1.0 / 3;
+
+  auto solve = [&](Axes const& on, InitialGuess const& initial_guess) {
+    DefaultMainMatrixCalculator3D calc(params, on[0], on[1], on[2]);
+    auto stencil = build_stencil(calc);
+    auto g_vector = build_g_vector(calc);
+    Eigen::VectorXd solution = initial_guess ? seven_point_solver(stencil, g_vector, initial_guess)
+                                             : seven_point_solver(stencil, g_vector);
+    auto values = with_boundary(calc, solution);
+    return std::pair {std::move(solution), std::move(values)};
+  };
+
+  Axes points = {std::move(x_points), std::move(y_points), std::move(z_points)};
+  GradedSolution result{};
+
+  Axes previous;
+  std::vector<double> previous_values;
+  while(true) {
+    auto start = std::chrono::steady_clock::now();
+
+    InitialGuess guess;
+    if(not previous_values.empty()) {
+      guess = [&] { return interpolate(previous, previous_values, points); };
+    }
+    auto [solution, values] = solve(points, guess);
+
+    // The coarsened grid has an eighth of the unknowns, its points are points of the grid and
+    // interpolation to them picks the values there
+    Axes coarse;
+    for(size_t axis = 0; axis < 3; ++axis) {
+      coarse[axis] = coarsen(points[axis]);
+    }
+    auto const coarse_solution = solve(coarse, {}).first;
+    auto const error_estimate =
+      richardson_factor * (interpolate(points, values, coarse) - coarse_solution).lpNorm<Eigen::Infinity>();
+
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    std::array<std::vector<double>, 3> indicators;
+    double indicator = 0;
+    for(size_t axis = 0; axis < 3; ++axis) {
+      indicators[axis] = axis_indicator(points, values, axis);
+      indicator = std::max(indicator, *std::max_element(indicators[axis].begin(), indicators[axis].end()));
+    }
+
+    result.levels.push_back({
+      points[0].size() - 1,
+      points[1].size() - 1,
+      points[2].size() - 1,
+      static_cast<size_t>(solution.size()),
+      error_estimate,
+      indicator,
+      elapsed.count()
+    });
+    result.error_estimate = error_estimate;
+    result.converged = error_estimate <= tolerance;
+    if(result.converged) {
+      result.solution = std::move(solution);
+      break;
+    }
+
+    // Only the intervals close to the largest indicator: while the layer is under-resolved its
+    // error bends the solution along the other axes as well, those would be refined for nothing
+    auto const threshold = marking_fraction * indicator;
+
+    Axes refined;
+    size_t unknowns = 1;
+    for(size_t axis = 0; axis < 3; ++axis) {
+      refined[axis] = refine_marked(points[axis], indicators[axis], threshold);
+      unknowns *= refined[axis].size() - 2;
+    }
+    if(unknowns > max_unknowns) {
+      result.solution = std::move(solution);
+      break;
+    }
+
+    previous = std::exchange(points, std::move(refined));
+    previous_values = std::move(values);
+  }
+
+  result.x_points = std::move(points[0]);
+  result.y_points = std::move(points[1]);
+  result.z_points = std::move(points[2]);
+  return result;
+}
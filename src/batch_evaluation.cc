@@ -0,0 +1,64 @@
+#include <batch_evaluation.hpp>
+
+#include <utility>
+
+#include <contract/contract.hpp>
+
+auto batched(X_Function_type scalar) -> Batch_X_Function_type
+{
+  return [scalar = std::move(scalar)](std::span<double const> x, std::span<double> out) {
+    evaluate({}, scalar, x, out);
+  };
+}
+
+auto batched(X_Y_Function_type scalar) -> Batch_X_Y_Function_type
+{
+  return [scalar = std::move(scalar)](
+           std::span<double const> x, std::span<double const> y, std::span<double> out
+         ) { evaluate({}, scalar, x, y, out); };
+}
+
+void evaluate(
+  Batch_X_Function_type const& batch,
+  X_Function_type const& scalar,
+  std::span<double const> x,
+  std::span<double> out
+)
+{
+  // clang-format off
+  contract(fun) {
+    precondition(x.size() == out.size(), "size mismatch");
+  };
+  // clang-format on
+
+  if(batch) {
+    batch(x, out);
+    return;
+  }
+  for(size_t n = 0; n < x.size(); ++n) {
+    out[n] = scalar(x[n]);
+  }
+}
+
+void evaluate(
+  Batch_X_Y_Function_type const& batch,
+  X_Y_Function_type const& scalar,
+  std::span<double const> x,
+  std::span<double const> y,
+  std::span<double> out
+)
+{
+  // clang-format off
+  contract(fun) {
+    precondition(x.size() == out.size() and y.size() == out.size(), "size mismatch");
+  };
+  // clang-format on
+
+  if(batch) {
+    batch(x, y, out);
+    return;
+  }
+  for(size_t n = 0; n < x.size(); ++n) {
+    out[n] = scalar(x[n], y[n]);
+  }
+}
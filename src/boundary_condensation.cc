@@ -0,0 +1,87 @@
+#include <boundary_condensation.hpp>
+
+#include <stdexcept>
+
+#include <contract/contract.hpp>
+
+#include <matrix_builder.hpp>
+
+auto condense_boundary(
+  IMainMatrixCalculator const& calc,
+  Eigen::SparseMatrix<double> const& matrix,
+  Eigen::VectorXd const& g
+) -> CondensedSystem
+{
+  auto const shape = grid_shape(calc);
+
+  // clang-format off
+  contract(fun) {
+    precondition(static_cast<size_t>(matrix.rows()) == shape.size(), "size mismatch");
+    precondition(static_cast<size_t>(matrix.cols()) == shape.size(), "size mismatch");
+    precondition(static_cast<size_t>(g.size()) == shape.size(), "size mismatch");
+  };
+  // clang-format on
+
+  using StorageIndex = Eigen::SparseMatrix<double>::StorageIndex;
+  static constexpr auto removed = StorageIndex(-1);
+
+  CondensedSystem system;
+  std::vector<StorageIndex> new_number(shape.size(), removed);
+
+  for(size_t i = 0; i < shape.nx; ++i) {
+    for(size_t j = 0; j < shape.ny; ++j) {
+      for(size_t k = 0; k < shape.nz; ++k) {
+        auto const idx = shape.index({i, j, k});
+        if(calc.is_first_type({i, j, k})) {
+          system.eliminated.push_back(idx);
+        }
+        else {
+          new_number[idx] = static_cast<StorageIndex>(system.kept.size());
+          system.kept.push_back(idx);
+        }
+      }
+    }
+  }
+
+  auto const kept_count = static_cast<Eigen::Index>(system.kept.size());
+
+  system.g.resize(kept_count);
+  for(Eigen::Index row = 0; row < kept_count; ++row) {
+    system.g(row) = g(system.kept[row]);
+  }
+
+  // Identity row up to scaling: value is g / diagonal, then the column goes to g. The
+  // off-diagonal entries of eliminated rows are checked while their columns are visited.
+  system.boundary_values.resize(system.eliminated.size());
+  for(size_t n = 0; n < system.eliminated.size(); ++n) {
+    auto const column = static_cast<Eigen::Index>(system.eliminated[n]);
+    auto const value = g(column) / matrix.coeff(column, column);
+    system.boundary_values(n) = value;
+
+    for(Eigen::SparseMatrix<double>::InnerIterator it(matrix, column); it; ++it) {
+      if(new_number[it.row()] != removed) {
+        system.g(new_number[it.row()]) -= it.value() * value;
+      }
+      else if(it.row() != column and it.value() != 0) {
+        throw std::invalid_argument("first type row has off-diagonal entries");
+      }
+    }
+  }
+
+  system.matrix.resize(kept_count, kept_count);
+  system.matrix.reserve(matrix.nonZeros());
+  for(Eigen::Index column = 0; column < kept_count; ++column) {
+    system.matrix.startVec(column);
+    for(Eigen::SparseMatrix<double>::InnerIterator it(matrix, system.kept[column]); it; ++it) {
+      if(new_number[it.row()] != removed) {
+        system.matrix.insertBack(new_number[it.row()], column) = it.value();
+      }
+      else if(it.value() != 0) {
+        throw std::invalid_argument("first type row has off-diagonal entries");
+      }
+    }
+  }
+  system.matrix.finalize();
+
+  return system;
+}
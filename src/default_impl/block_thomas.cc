@@ -0,0 +1,135 @@
+#include <default_impl/block_thomas.hpp>
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <contract/contract.hpp>
+
+namespace
+{
+  using RowMajorSparse = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+
+  // Block of `size` values starting at block * size, fixed-size when K is
+  template<int K>
+  auto segment(Eigen::Ref<Eigen::VectorXd> v, Eigen::Index block, Eigen::Index size)
+  {
+    if constexpr(K == Eigen::Dynamic) {
+      return v.segment(block * size, size);
+    } else {
+      return v.template segment<K>(block * K);
+    }
+  }
+
+  // K == Eigen::Dynamic handles any block size, other instantiations only K
+  template<int K>
+  void block_thomas(RowMajorSparse const& matrix, Eigen::Ref<Eigen::VectorXd> g, Eigen::Index size)
+  {
+    using Block = Eigen::Matrix<double, K, K>;
+    using Vector = Eigen::Matrix<double, K, 1>;
+
+    auto const blocks = matrix.rows() / size;
+
+    // Sub-, main and super-diagonal blocks of block row i
+    Block lower(size, size);
+    Block diagonal(size, size);
+    Block upper(size, size);
+    auto load_row = [&](Eigen::Index i) {
+      lower.setZero();
+      diagonal.setZero();
+      upper.setZero();
+      for(Eigen::Index row = 0; row < size; ++row) {
+        for(RowMajorSparse::InnerIterator it(matrix, i * size + row); it; ++it) {
+          auto const column_block = it.col() / size;
+          auto const column = it.col() % size;
+          if(column_block == i) {
+            diagonal(row, column) = it.value();
+          } else if(column_block + 1 == i) {
+            lower(row, column) = it.value();
+          } else if(column_block == i + 1) {
+            upper(row, column) = it.value();
+          } else {
+            throw std::invalid_argument("matrix is not block tridiagonal");
+          }
+        }
+      }
+    };
+
+    // Forward elimination: D'_i = D_i - L_i C'_{i-1}, C'_i = D'_i^{-1} U_i,
+    // g'_i = D'_i^{-1} (g_i - L_i g'_{i-1})
+    std::vector<Block, Eigen::aligned_allocator<Block>> reduced_upper(blocks, Block::Zero(size, size));
+    Eigen::PartialPivLU<Block> lu(size);
+    Vector previous(size);
+    for(Eigen::Index i = 0; i < blocks; ++i) {
+      load_row(i);
+      Vector rhs = segment<K>(g, i, size);
+      if(i > 0) {
+        diagonal.noalias() -= lower * reduced_upper[i - 1];
+        rhs.noalias() -= lower * previous;
+      }
+      lu.compute(diagonal);
+      if(i + 1 < blocks) {
+        reduced_upper[i] = lu.solve(upper);
+      }
+      previous = lu.solve(rhs);
+      segment<K>(g, i, size) = previous;
+    }
+
+    // Back substitution: x_i = g'_i - C'_i x_{i+1}
+    for(Eigen::Index i = blocks - 1; i-- > 0;) {
+      previous = reduced_upper[i] * previous;
+      segment<K>(g, i, size) -= previous;
+      previous = segment<K>(g, i, size);
+    }
+  }
+
+  // Picks the instantiation for `size`, Sizes holds the fixed ones
+  template<int... Sizes>
+  void dispatch(
+    std::integer_sequence<int, Sizes...>,
+    RowMajorSparse const& matrix,
+    Eigen::Ref<Eigen::VectorXd> g,
+    Eigen::Index size
+  )
+  {
+    bool const fixed = ((size == Sizes + 1 and (block_thomas<Sizes + 1>(matrix, g, size), true)) or ...);
+    if(not fixed) {
+      block_thomas<Eigen::Dynamic>(matrix, g, size);
+    }
+  }
+}  // namespace
+
+void block_thomas_solve(
+  Eigen::SparseMatrix<double> const& matrix,
+  Eigen::Ref<Eigen::VectorXd> g,
+  size_t block_size
+)
+{
+  // clang-format off
+  contract(fun) {
+    precondition(block_size > 0, "block size must be positive");
+    precondition(matrix.rows() == matrix.cols(), "matrix must be square");
+    precondition(matrix.rows() == g.size(), "size mismatch");
+    precondition(matrix.rows() % static_cast<Eigen::Index>(block_size) == 0, "size must be a multiple of block_size");
+  };
+  // clang-format on
+
+  RowMajorSparse const rows = matrix;
+  dispatch(
+    std::make_integer_sequence<int, static_cast<int>(max_fixed_block_size)> {},
+    rows,
+    g,
+    static_cast<Eigen::Index>(block_size)
+  );
+}
+
+auto block_thomas_solver(
+  Eigen::SparseMatrix<double> const& matrix,
+  Eigen::Ref<Eigen::VectorXd const> g,
+  size_t block_size
+) -> Eigen::VectorXd
+{
+  Eigen::VectorXd w = g;
+  block_thomas_solve(matrix, w, block_size);
+  return w;
+}
@@ -1,9 +1,11 @@
 #include <default_impl/main_matrix_calculator.hpp>
 
+#include <algorithm>
 #include <cassert>
 
 #include <contract/contract.hpp>
 
+#include <batch_evaluation.hpp>
 #include <interval_splitter.hpp>
 
 auto DefaultMainMatrixCalculator::calc_a(Index index) const -> double
@@ -137,6 +139,66 @@ auto DefaultMainMatrixCalculator::calc_g(Index index) const -> double
   }
 }
 
+void DefaultMainMatrixCalculator::calc_g_edges(std::span<double> g) const
+{
+  auto const nx = m_x_points.size() - 2;
+  auto const ny = m_y_points.size() - 2;
+
+  // clang-format off
+  contract(fun) {
+    precondition(g.size() == nx * ny, "size mismatch");
+  };
+  // clang-format on
+
+  if(nx == 0 or ny == 0) {
+    return;
+  }
+
+  // Unknowns cover the interiour points only, so calc_g never takes its i == Nx and
+  // j == Nx branches here: row 0 is u1, the other rows start with u3
+  std::span<double const> const x_points = m_x_points;
+  std::span<double const> const y_points = m_y_points;
+  evaluate(m_input_p->u1_batch, m_input_p->u1, y_points.first(ny), g.first(ny));
+
+  if(nx > 1) {
+    std::vector<double> edge(nx - 1);
+    evaluate(m_input_p->u3_batch, m_input_p->u3, x_points.subspan(1, nx - 1), edge);
+    for(size_t i = 1; i < nx; ++i) {
+      g[i * ny] = edge[i - 1];
+    }
+  }
+}
+
+void DefaultMainMatrixCalculator::calc_g_planes(size_t begin, size_t end, std::span<double> g) const
+{
+  auto const nx = m_x_points.size() - 2;
+  auto const ny = m_y_points.size() - 2;
+
+  // clang-format off
+  contract(fun) {
+    precondition(begin <= end and end <= nx, "planes out of range");
+    precondition(g.size() == (end - begin) * ny, "size mismatch");
+  };
+  // clang-format on
+
+  if(ny < 2) {
+    return;
+  }
+
+  // Row 0 and the first value of the other rows are edges, the rest of every row is f
+  auto sq = [](auto x) { return x * x; };
+  std::span<double const> const y_points = m_y_points;
+  std::vector<double> row_x(ny - 1);
+  for(size_t i = std::max<size_t>(begin, 1); i < end; ++i) {
+    std::fill(row_x.begin(), row_x.end(), m_x_points[i]);
+    auto values = g.subspan((i - begin) * ny + 1, ny - 1);
+    evaluate(m_input_p->f_batch, m_input_p->f, row_x, y_points.subspan(1, ny - 1), values);
+    for(size_t j = 1; j < ny; ++j) {
+      values[j - 1] *= sq(calc_h(m_y_points, j));
+    }
+  }
+}
+
 auto DefaultMainMatrixCalculator::calc_d(Index index) const -> double
 {
   // clang-format off
@@ -199,3 +261,11 @@ auto DefaultMainMatrixCalculator::calc_e(Index index) const -> double
     return -1;
   }
 }
+
+auto DefaultMainMatrixCalculator::is_first_type(Index index) const -> bool
+{
+  // u1 at x == xl and u3 at y == yl. Unknowns are numbered over the first Nx - 1 x and
+  // Ny - 1 y points, so the u4 edge (j == Ny) and the third type rows at x == xr (i == Nx)
+  // are not part of the assembled system and there is nothing of them to condense.
+  return index.i == 0 or (index.i < m_x_points.size() - 1 and index.j == 0);
+}
@@ -0,0 +1,178 @@
+#include <default_impl/main_matrix_calculator_3d.hpp>
+
+#include <array>
+
+#include <contract/contract.hpp>
+
+#include <interval_splitter.hpp>
+
+DefaultMainMatrixCalculator3D::DefaultMainMatrixCalculator3D(
+  std::shared_ptr<InputParameters3D> params,
+  std::vector<double> x_points,
+  std::vector<double> y_points,
+  std::vector<double> z_points
+)
+  : m_input_p(std::move(params))
+  , m_x_points(std::move(x_points))
+  , m_y_points(std::move(y_points))
+  , m_z_points(std::move(z_points))
+{
+  // clang-format off
+  contract(fun) {
+    precondition(m_x_points.size() > 2 and m_y_points.size() > 2 and m_z_points.size() > 2, "every axis needs at least 2 intervals");
+  };
+  // clang-format on
+}
+
+auto DefaultMainMatrixCalculator3D::conductance(Index point, int axis, int shift) const -> double
+{
+  std::array<std::vector<double> const*, 3> const points = {&m_x_points, &m_y_points, &m_z_points};
+  std::array<size_t, 3> const at = {point.i, point.j, point.k};
+
+  // Index of the right end of the crossed interval
+  auto const face = shift < 0 ? at[axis] : at[axis] + 1;
+
+  std::array<double, 3> center = {m_x_points[point.i], m_y_points[point.j], m_z_points[point.k]};
+  center[axis] = middle_point(*points[axis], face);
+
+  double area = 1;
+  for(int other = 0; other < 3; ++other) {
+    if(other != axis) {
+      area *= calc_cross_h(*points[other], at[other]);
+    }
+  }
+
+  return m_input_p->k(center[0], center[1], center[2]) * area / calc_h(*points[axis], face);
+}
+
+// Interior unknown (i, j, k) is the grid point (i + 1, j + 1, k + 1)
+static auto to_point(Index index) -> Index
+{
+  return {index.i + 1, index.j + 1, index.k + 1};
+}
+
+auto DefaultMainMatrixCalculator3D::calc_a(Index index) const -> double
+{
+  // clang-format off
+  contract(fun) {
+    precondition(index.i + 2 < m_x_points.size(), "index out of range");
+    precondition(index.j + 2 < m_y_points.size(), "index out of range");
+    precondition(index.k + 2 < m_z_points.size(), "index out of range");
+  };
+  // clang-format on
+
+  return -conductance(to_point(index), 1, -1);
+}
+
+auto DefaultMainMatrixCalculator3D::calc_b(Index index) const -> double
+{
+  // clang-format off
+  contract(fun) {
+    precondition(index.i + 2 < m_x_points.size(), "index out of range");
+    precondition(index.j + 2 < m_y_points.size(), "index out of range");
+    precondition(index.k + 2 < m_z_points.size(), "index out of range");
+  };
+  // clang-format on
+
+  return -conductance(to_point(index), 1, +1);
+}
+
+auto DefaultMainMatrixCalculator3D::calc_d(Index index) const -> double
+{
+  // clang-format off
+  contract(fun) {
+    precondition(index.i + 2 < m_x_points.size(), "index out of range");
+    precondition(index.j + 2 < m_y_points.size(), "index out of range");
+    precondition(index.k + 2 < m_z_points.size(), "index out of range");
+  };
+  // clang-format on
+
+  return -conductance(to_point(index), 0, -1);
+}
+
+auto DefaultMainMatrixCalculator3D::calc_e(Index index) const -> double
+{
+  // clang-format off
+  contract(fun) {
+    precondition(index.i + 2 < m_x_points.size(), "index out of range");
+    precondition(index.j + 2 < m_y_points.size(), "index out of range");
+    precondition(index.k + 2 < m_z_points.size(), "index out of range");
+  };
+  // clang-format on
+
+  return -conductance(to_point(index), 0, +1);
+}
+
+auto DefaultMainMatrixCalculator3D::calc_p(Index index) const -> double
+{
+  // clang-format off
+  contract(fun) {
+    precondition(index.i + 2 < m_x_points.size(), "index out of range");
+    precondition(index.j + 2 < m_y_points.size(), "index out of range");
+    precondition(index.k + 2 < m_z_points.size(), "index out of range");
+  };
+  // clang-format on
+
+  return -conductance(to_point(index), 2, -1);
+}
+
+auto DefaultMainMatrixCalculator3D::calc_q(Index index) const -> double
+{
+  // clang-format off
+  contract(fun) {
+    precondition(index.i + 2 < m_x_points.size(), "index out of range");
+    precondition(index.j + 2 < m_y_points.size(), "index out of range");
+    precondition(index.k + 2 < m_z_points.size(), "index out of range");
+  };
+  // clang-format on
+
+  return -conductance(to_point(index), 2, +1);
+}
+
+auto DefaultMainMatrixCalculator3D::calc_c(Index index) const -> double
+{
+  return -(calc_a(index) + calc_b(index) + calc_d(index) + calc_e(index) + calc_p(index)
+           + calc_q(index));
+}
+
+auto DefaultMainMatrixCalculator3D::calc_g(Index index) const -> double
+{
+  // clang-format off
+  contract(fun) {
+    precondition(index.i + 2 < m_x_points.size(), "index out of range");
+    precondition(index.j + 2 < m_y_points.size(), "index out of range");
+    precondition(index.k + 2 < m_z_points.size(), "index out of range");
+  };
+  // clang-format on
+
+  auto const point = to_point(index);
+  auto const x = m_x_points[point.i];
+  auto const y = m_y_points[point.j];
+  auto const z = m_z_points[point.k];
+
+  auto const volume = calc_cross_h(m_x_points, point.i) * calc_cross_h(m_y_points, point.j)
+                    * calc_cross_h(m_z_points, point.k);
+  auto g = volume * m_input_p->f(x, y, z);
+
+  // Neighbours on the boundary are known, move them to the right side
+  if(point.i == 1) {
+    g -= calc_d(index) * m_input_p->u0(m_x_points.front(), y, z);
+  }
+  if(point.i == m_x_points.size() - 2) {
+    g -= calc_e(index) * m_input_p->u0(m_x_points.back(), y, z);
+  }
+  if(point.j == 1) {
+    g -= calc_a(index) * m_input_p->u0(x, m_y_points.front(), z);
+  }
+  if(point.j == m_y_points.size() - 2) {
+    g -= calc_b(index) * m_input_p->u0(x, m_y_points.back(), z);
+  }
+  if(point.k == 1) {
+    g -= calc_p(index) * m_input_p->u0(x, y, m_z_points.front());
+  }
+  if(point.k == m_z_points.size() - 2) {
+    g -= calc_q(index) * m_input_p->u0(x, y, m_z_points.back());
+  }
+
+  return g;
+}
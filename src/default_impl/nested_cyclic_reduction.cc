@@ -0,0 +1,329 @@
+#include <default_impl/nested_cyclic_reduction.hpp>
+
+#include <cmath>
+#include <functional>
+#include <numbers>
+
+#include <contract/contract.hpp>
+
+#include <default_impl/odd_even_reduction.hpp>
+
+namespace
+{
+  // Replaces v with (B + shift * I)^{-1} v
+  using ShiftedSolve = std::function<void(double shift, Eigen::Ref<Eigen::VectorXd> v)>;
+
+  auto is_two_power_minus_one(size_t n) -> bool
+  {
+    return n > 0 and ((n + 1) & n) == 0;
+  }
+
+  auto same(double lhs, double rhs) -> bool
+  {
+    return std::abs(lhs - rhs) <= 1e-12 * std::max(std::abs(lhs), std::abs(rhs));
+  }
+
+  // Replaces v with (A_r)^{-1} v, where A_0 = B / coupling and A_{r+1} = 2I - A_r^2.
+  // A_r = -prod (A_0 + 2 cos(theta_l) I), theta_l = (2l - 1) pi / 2^{r+1}, l = 1..2^r
+  // (without the minus for r == 0), so one shifted block solve is done per factor.
+  void apply_reduced_inverse(
+    size_t level,
+    double coupling,
+    ShiftedSolve const& solve,
+    Eigen::Ref<Eigen::VectorXd> v
+  )
+  {
+    // Factors with theta near 0 are nearly singular when the y (or z) coupling is weak, their
+    // partial products overflow on long grids although A_r^{-1} v is small. v is kept
+    // normalized and its scale is applied at the end.
+    double log_scale = 0;
+    size_t const factors = size_t(1) << level;
+    for(size_t l = 1; l <= factors; ++l) {
+      auto const theta = (2 * l - 1) * std::numbers::pi / (2 * factors);
+      v *= coupling;
+      solve(2 * std::cos(theta) * coupling, v);
+
+      auto const norm = v.lpNorm<Eigen::Infinity>();
+      if(norm > 0) {
+        v /= norm;
+        log_scale += std::log(norm);
+      }
+    }
+
+    v *= level > 0 ? -std::exp(log_scale) : std::exp(log_scale);
+  }
+
+  /// @return number of values `workspace` of buneman_solve needs
+  auto buneman_workspace_size(size_t n, size_t block) -> size_t
+  {
+    // Buneman's p blocks and one temporary block
+    return (n + 1) * block;
+  }
+
+  // Solves coupling * (w(j-1) + w(j+1)) + B w(j) = rhs(j), j = 1..n, in place, where every
+  // block w(j) is a contiguous segment of `block` values and n = 2^m - 1.
+  // `workspace` holds buneman_workspace_size(n, block) values, `solve` must not use it.
+  void buneman_solve(
+    size_t n,
+    size_t block,
+    double coupling,
+    ShiftedSolve const& solve,
+    Eigen::Ref<Eigen::VectorXd> rhs,
+    Eigen::Ref<Eigen::VectorXd> workspace
+  )
+  {
+    auto q = [&](size_t j) { return rhs.segment((j - 1) * block, block); };
+
+    auto p_storage = workspace.head(n * block);
+    p_storage.setZero();
+    auto p = [&](size_t j) { return p_storage.segment((j - 1) * block, block); };
+
+    rhs /= coupling;
+
+    size_t levels = 0;
+    while((size_t(1) << (levels + 1)) <= n + 1) {
+      ++levels;
+    }
+
+    auto t = workspace.segment(n * block, block);
+
+    // Reduction: only every 2h-th block stays at the next level
+    for(size_t level = 0; level + 1 < levels; ++level) {
+      size_t const h = size_t(1) << level;
+      for(size_t j = 2 * h; j <= n; j += 2 * h) {
+        t = p(j - h) + p(j + h) - q(j);
+        apply_reduced_inverse(level, coupling, solve, t);
+        p(j) -= t;
+        q(j) = q(j - h) + q(j + h) - 2 * p(j);
+      }
+    }
+
+    // Back substitution, solution replaces q block by block
+    for(size_t level = levels; level-- > 0;) {
+      size_t const h = size_t(1) << level;
+      for(size_t j = h; j <= n; j += 2 * h) {
+        t = q(j);
+        if(j > h) {
+          t -= q(j - h);
+        }
+        if(j + h <= n) {
+          t -= q(j + h);
+        }
+        apply_reduced_inverse(level, coupling, solve, t);
+        q(j) = p(j) + t;
+      }
+    }
+  }
+}
+
+auto extract_separable_stencil(Stencil7 const& stencil) -> std::optional<SeparableStencil3D>
+{
+  auto const& shape = stencil.shape;
+  auto const nz = static_cast<Eigen::Index>(shape.nz);
+
+  SeparableStencil3D op {
+    shape,
+    1,
+    Eigen::VectorXd(nz),
+    Eigen::VectorXd(nz),
+    Eigen::VectorXd(nz),
+    Eigen::VectorXd::Ones(nz)
+  };
+
+  // Reference values are taken from the first line
+  for(size_t k = 0; k < shape.nz; ++k) {
+    if(shape.nx > 1) {
+      auto const x_coupling = stencil.e(k);
+      if(x_coupling == 0) {
+        return std::nullopt;
+      }
+      op.row_scale(k) = 1 / x_coupling;
+    }
+    op.line_a(k) = stencil.p(k) * op.row_scale(k);
+    op.line_b(k) = stencil.c(k) * op.row_scale(k);
+    op.line_c(k) = stencil.q(k) * op.row_scale(k);
+  }
+
+  if(shape.ny > 1) {
+    op.y_coupling = stencil.b(0) * op.row_scale(0);
+    if(op.y_coupling == 0) {
+      return std::nullopt;
+    }
+  }
+
+  for(size_t i = 0; i < shape.nx; ++i) {
+    for(size_t j = 0; j < shape.ny; ++j) {
+      for(size_t k = 0; k < shape.nz; ++k) {
+        auto const idx = shape.index({i, j, k});
+        auto const scale = op.row_scale(k);
+
+        bool const separable =
+          (i == 0 or same(stencil.d(idx) * scale, 1))
+          and (i + 1 == shape.nx or same(stencil.e(idx) * scale, 1))
+          and (j == 0 or same(stencil.a(idx) * scale, op.y_coupling))
+          and (j + 1 == shape.ny or same(stencil.b(idx) * scale, op.y_coupling))
+          and same(stencil.p(idx) * scale, op.line_a(k))
+          and same(stencil.c(idx) * scale, op.line_b(k))
+          and same(stencil.q(idx) * scale, op.line_c(k));
+
+        if(not separable) {
+          return std::nullopt;
+        }
+      }
+    }
+  }
+
+  return op;
+}
+
+auto nested_cyclic_reduction_solver(SeparableStencil3D const& op, Eigen::VectorXd const& g)
+  -> Eigen::VectorXd
+{
+  Eigen::VectorXd w = g;
+  nested_cyclic_reduction_solve(op, w);
+  return w;
+}
+
+void nested_cyclic_reduction_solve(SeparableStencil3D const& op, Eigen::Ref<Eigen::VectorXd> g)
+{
+  auto const& shape = op.shape;
+
+  // clang-format off
+  contract(fun) {
+    precondition(static_cast<size_t>(g.size()) == shape.size(), "size mismatch");
+    precondition(is_two_power_minus_one(shape.nx), "nx must be 2^m - 1");
+    precondition(is_two_power_minus_one(shape.ny), "ny must be 2^m - 1");
+  };
+  // clang-format on
+
+  // Buneman's blocks of the planes and of the lines on one plane, the plane solves run one
+  // after another so a single line level workspace serves all of them
+  Eigen::VectorXd workspace(buneman_workspace_size(shape.nx, shape.ny * shape.nz));
+  Eigen::VectorXd plane_workspace(buneman_workspace_size(shape.ny, shape.nz));
+
+  // Points: (L + shift * I) along one line
+  Eigen::VectorXd shifted_b(shape.nz);
+  Eigen::VectorXd line_workspace(odd_even_reduction_workspace_size(shape.nz));
+  auto solve_line = [&](double shift, Eigen::Ref<Eigen::VectorXd> line) {
+    shifted_b = op.line_b.array() + shift;
+    odd_even_reduction_solve(op.line_a, shifted_b, op.line_c, line, line_workspace);
+  };
+
+  // Lines: (P + shift * I) on one plane, P couples the lines through y_coupling
+  auto solve_plane = [&](double shift, Eigen::Ref<Eigen::VectorXd> plane) {
+    buneman_solve(
+      shape.ny,
+      shape.nz,
+      op.y_coupling,
+      [&](double line_shift, Eigen::Ref<Eigen::VectorXd> line) {
+        solve_line(shift + line_shift, line);
+      },
+      plane,
+      plane_workspace
+    );
+  };
+
+  for(size_t line = 0; line < shape.nx * shape.ny; ++line) {
+    g.segment(line * shape.nz, shape.nz).array() *= op.row_scale.array();
+  }
+
+  // Planes
+  buneman_solve(shape.nx, shape.ny * shape.nz, 1, solve_plane, g, workspace);
+}
+
+auto matrix_free_cg_solver(
+  Stencil7 const& stencil,
+  Eigen::Ref<Eigen::VectorXd const> g,
+  double tolerance,
+  size_t max_iterations
+) -> Eigen::VectorXd
+{
+  return matrix_free_cg_solver(stencil, g, Eigen::VectorXd::Zero(g.size()), tolerance, max_iterations);
+}
+
+auto matrix_free_cg_solver(
+  Stencil7 const& stencil,
+  Eigen::Ref<Eigen::VectorXd const> g,
+  Eigen::Ref<Eigen::VectorXd const> initial_guess,
+  double tolerance,
+  size_t max_iterations
+) -> Eigen::VectorXd
+{
+  auto const& shape = stencil.shape;
+
+  // clang-format off
+  contract(fun) {
+    precondition(static_cast<size_t>(g.size()) == shape.size(), "size mismatch");
+    precondition(initial_guess.size() == g.size(), "size mismatch");
+  };
+  // clang-format on
+
+  if(max_iterations == 0) {
+    max_iterations = shape.size();
+  }
+
+  auto precondition_lines = [&](Eigen::VectorXd const& r, Eigen::VectorXd& z) {
+    z = r;
+    odd_even_reduction_solve_lines(stencil.p, stencil.c, stencil.q, z, shape.nz);
+  };
+
+  Eigen::VectorXd w = initial_guess;
+  Eigen::VectorXd r = g - apply_stencil(stencil, w);
+  Eigen::VectorXd z(g.size());
+  precondition_lines(r, z);
+  Eigen::VectorXd direction = z;
+  double rz = r.dot(z);
+  auto const stop = tolerance * g.norm();
+
+  for(size_t iteration = 0; iteration < max_iterations and r.norm() > stop; ++iteration) {
+    Eigen::VectorXd const a_direction = apply_stencil(stencil, direction);
+    auto const alpha = rz / direction.dot(a_direction);
+    w += alpha * direction;
+    r -= alpha * a_direction;
+
+    precondition_lines(r, z);
+    auto const rz_next = r.dot(z);
+    direction = z + (rz_next / rz) * direction;
+    rz = rz_next;
+  }
+
+  return w;
+}
+
+namespace
+{
+  auto try_nested_cyclic_reduction(Stencil7 const& stencil, Eigen::Ref<Eigen::VectorXd const> g)
+    -> std::optional<Eigen::VectorXd>
+  {
+    auto const& shape = stencil.shape;
+    if(is_two_power_minus_one(shape.nx) and is_two_power_minus_one(shape.ny)) {
+      if(auto separable = extract_separable_stencil(stencil)) {
+        Eigen::VectorXd w = g;
+        nested_cyclic_reduction_solve(*separable, w);
+        return w;
+      }
+    }
+    return std::nullopt;
+  }
+}  // namespace
+
+auto seven_point_solver(Stencil7 const& stencil, Eigen::Ref<Eigen::VectorXd const> g)
+  -> Eigen::VectorXd
+{
+  if(auto w = try_nested_cyclic_reduction(stencil, g)) {
+    return std::move(*w);
+  }
+  return matrix_free_cg_solver(stencil, g);
+}
+
+auto seven_point_solver(
+  Stencil7 const& stencil,
+  Eigen::Ref<Eigen::VectorXd const> g,
+  InitialGuess const& initial_guess
+) -> Eigen::VectorXd
+{
+  if(auto w = try_nested_cyclic_reduction(stencil, g)) {
+    return std::move(*w);
+  }
+  return matrix_free_cg_solver(stencil, g, initial_guess());
+}
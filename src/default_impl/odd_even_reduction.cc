@@ -1,46 +1,175 @@
 #include <default_impl/odd_even_reduction.hpp>
 
-Eigen::VectorXd odd_even_reduction_solver(
-  Eigen::VectorXd const& a,
-  Eigen::VectorXd const& b,
-  Eigen::VectorXd const& c,
-  Eigen::VectorXd const& rhs
-)
+#include <algorithm>
+
+#include <contract/contract.hpp>
+
+#include <parallel.hpp>
+#include <tuning.hpp>
+
+auto odd_even_reduction_workspace_size(size_t n) -> size_t
 {
-  int n = rhs.size();
+  // Every level keeps four vectors of half the size
+  return 4 * n;
+}
 
-  if(n == 1) {
-    return rhs.array() / b.array();
+namespace
+{
+  // Forward elimination keeps the modified upper diagonal in `workspace`
+  void thomas_solve(
+    ConstStridedVector a,
+    ConstStridedVector b,
+    ConstStridedVector c,
+    StridedVector rhs,
+    Eigen::Ref<Eigen::VectorXd> workspace
+  )
+  {
+    auto const n = rhs.size();
+
+    workspace[0] = c[0] / b[0];
+    rhs[0] /= b[0];
+    for(Eigen::Index i = 1; i < n; ++i) {
+      double const m = b[i] - a[i] * workspace[i - 1];
+      workspace[i] = c[i] / m;
+      rhs[i] = (rhs[i] - a[i] * rhs[i - 1]) / m;
+    }
+
+    for(Eigen::Index i = n - 1; i-- > 0;) {
+      rhs[i] -= workspace[i] * rhs[i + 1];
+    }
   }
 
-  int n_half = n / 2;
-  Eigen::VectorXd a_half(n_half), b_half(n_half), c_half(n_half), rhs_half(n_half);
+  // Recursion of odd_even_reduction_solve, `cutoff` is read once by the caller so that all
+  // levels of one solve use the same value
+  void reduce(
+    ConstStridedVector a,
+    ConstStridedVector b,
+    ConstStridedVector c,
+    StridedVector rhs,
+    Eigen::Ref<Eigen::VectorXd> workspace,
+    size_t cutoff
+  )
+  {
+    int n = rhs.size();
+
+    if(n == 0) {
+      return;
+    }
 
-  for(int i = 0; i < n_half; ++i) {
-    int j = 2 * i + 1;
-    double denom = b[j] - a[j] * c[j - 1] / b[j - 1];
+    if(static_cast<size_t>(n) <= cutoff) {
+      thomas_solve(a, b, c, rhs, workspace);
+      return;
+    }
 
-    b_half[i] = denom;
-    rhs_half[i] = rhs[j] - a[j] * rhs[j - 1] / b[j - 1];
+    // Every odd row is combined with both of its even neighbours, which drops
+    // the even unknowns and leaves a tridiagonal system of half the size
+    int n_half = n / 2;
+    auto a_half = workspace.segment(0, n_half);
+    auto b_half = workspace.segment(n_half, n_half);
+    auto c_half = workspace.segment(2 * n_half, n_half);
+    auto rhs_half = workspace.segment(3 * n_half, n_half);
+
+    for(int i = 0; i < n_half; ++i) {
+      int j = 2 * i + 1;
+      double alpha = -a[j] / b[j - 1];
+      double gamma = j + 1 < n ? -c[j] / b[j + 1] : 0;
+
+      a_half[i] = alpha * a[j - 1];
+      b_half[i] = b[j] + alpha * c[j - 1] + (j + 1 < n ? gamma * a[j + 1] : 0);
+      c_half[i] = j + 1 < n ? gamma * c[j + 1] : 0;
+      rhs_half[i] = rhs[j] + alpha * rhs[j - 1] + (j + 1 < n ? gamma * rhs[j + 1] : 0);
+    }
 
-    if(j + 1 < n) {
-      a_half[i] = -a[j + 1];
-      c_half[i] = -c[j - 1] * c[j] / b[j];
+    reduce(
+      a_half,
+      b_half,
+      c_half,
+      rhs_half,
+      workspace.segment(4 * n_half, workspace.size() - 4 * n_half),
+      cutoff
+    );
+
+    for(int i = 0; i < n_half; ++i) {
+      rhs[2 * i + 1] = rhs_half[i];
+    }
+
+    for(int j = 0; j < n; j += 2) {
+      double sum = rhs[j];
+      if(j > 0) {
+        sum -= a[j] * rhs[j - 1];
+      }
+      if(j + 1 < n) {
+        sum -= c[j] * rhs[j + 1];
+      }
+      rhs[j] = sum / b[j];
     }
   }
+}  // namespace
+
+void odd_even_reduction_solve(
+  ConstStridedVector a,
+  ConstStridedVector b,
+  ConstStridedVector c,
+  StridedVector rhs,
+  Eigen::Ref<Eigen::VectorXd> workspace
+)
+{
+  auto const n = rhs.size();
 
-  Eigen::VectorXd x_half = odd_even_reduction_solver(a_half, b_half, c_half, rhs_half);
+  // clang-format off
+  contract(fun) {
+    precondition(a.size() == n and b.size() == n and c.size() == n, "size mismatch");
+    precondition(static_cast<size_t>(workspace.size()) >= odd_even_reduction_workspace_size(n), "workspace too small");
+  };
+  // clang-format on
 
-  Eigen::VectorXd x(n);
-  for(int i = 0; i < n_half; ++i) {
-    x[2 * i + 1] = x_half[i];
-  }
+  reduce(a, b, c, rhs, workspace, active_tuning().thomas_cutoff);
+}
 
-  for(int i = 0; i < n_half; ++i) {
-    int j = 2 * i;
-    x[j] = (rhs[j] - c[j] * x[j + 1]) / b[j];
-  }
+void odd_even_reduction_solve_lines(
+  Eigen::Ref<Eigen::VectorXd const> a,
+  Eigen::Ref<Eigen::VectorXd const> b,
+  Eigen::Ref<Eigen::VectorXd const> c,
+  Eigen::Ref<Eigen::VectorXd> rhs,
+  size_t length
+)
+{
+  // clang-format off
+  contract(fun) {
+    precondition(length > 0 and rhs.size() % length == 0, "rhs is not made of whole lines");
+    precondition(a.size() == rhs.size() and b.size() == rhs.size() and c.size() == rhs.size(), "size mismatch");
+  };
+  // clang-format on
+
+  auto const& tuning = active_tuning();
+  auto const n = static_cast<Eigen::Index>(length);
+
+  parallel_for(rhs.size() / length, tuning.line_batch, tuning.threads, [&](size_t begin, size_t end) {
+    Eigen::VectorXd workspace(odd_even_reduction_workspace_size(length));
+    for(size_t line = begin; line < end; ++line) {
+      auto const from = static_cast<Eigen::Index>(line * length);
+      reduce(
+        a.segment(from, n),
+        b.segment(from, n),
+        c.segment(from, n),
+        rhs.segment(from, n),
+        workspace,
+        tuning.thomas_cutoff
+      );
+    }
+  });
+}
 
+Eigen::VectorXd odd_even_reduction_solver(
+  Eigen::VectorXd const& a,
+  Eigen::VectorXd const& b,
+  Eigen::VectorXd const& c,
+  Eigen::VectorXd const& rhs
+)
+{
+  Eigen::VectorXd x = rhs;
+  Eigen::VectorXd workspace(odd_even_reduction_workspace_size(rhs.size()));
+  odd_even_reduction_solve(a, b, c, x, workspace);
   return x;
 }
 
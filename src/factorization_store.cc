@@ -0,0 +1,383 @@
+#include <factorization_store.hpp>
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <contract/contract.hpp>
+
+namespace
+{
+  constexpr std::array<char, 8> magic = {'C', 'O', 'U', 'R', 'S', 'E', 'L', 'U'};
+  constexpr std::uint32_t version = 1;
+
+  struct Header
+  {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t index_size;
+    std::uint64_t key;
+    std::uint64_t rows;
+    std::uint64_t lower_nonzeros;
+    std::uint64_t upper_nonzeros;
+    std::uint64_t checksum;  // of everything after the header
+  };
+
+  static_assert(sizeof(Header) % 8 == 0);
+
+  // FNV-1a, used for the key
+  class Hash
+  {
+   public:
+    void add(void const* data, size_t size)
+    {
+      auto const* bytes = static_cast<unsigned char const*>(data);
+      for(size_t i = 0; i < size; ++i) {
+        m_value = (m_value ^ bytes[i]) * 0x100000001b3ull;
+      }
+    }
+
+    template<typename T>
+    void add(T const& value)
+    {
+      add(&value, sizeof(value));
+    }
+
+    auto value() const -> std::uint64_t { return m_value; }
+
+   private:
+    std::uint64_t m_value = 0xcbf29ce484222325ull;
+  };
+
+  // FNV-1a over 8-byte words, the payload is checked on every open and byte steps are
+  // too slow for it. Data may come in pieces of any size, the total must be a multiple of 8.
+  class Checksum
+  {
+   public:
+    void add(void const* data, size_t size)
+    {
+      auto const* bytes = static_cast<unsigned char const*>(data);
+      while(size > 0 and m_pending_size > 0) {
+        push_byte(*bytes++);
+        --size;
+      }
+      for(; size >= 8; bytes += 8, size -= 8) {
+        std::uint64_t word;
+        std::memcpy(&word, bytes, 8);
+        add_word(word);
+      }
+      while(size-- > 0) {
+        push_byte(*bytes++);
+      }
+    }
+
+    auto value() const -> std::uint64_t { return m_value; }
+
+   private:
+    void add_word(std::uint64_t word) { m_value = (m_value ^ word) * 0x100000001b3ull; }
+
+    void push_byte(unsigned char byte)
+    {
+      m_pending[m_pending_size++] = byte;
+      if(m_pending_size == 8) {
+        std::uint64_t word;
+        std::memcpy(&word, m_pending.data(), 8);
+        add_word(word);
+        m_pending_size = 0;
+      }
+    }
+
+    std::uint64_t m_value = 0xcbf29ce484222325ull;
+    std::array<unsigned char, 8> m_pending {};
+    size_t m_pending_size = 0;
+  };
+
+  auto padded(size_t bytes) -> size_t
+  {
+    return (bytes + 7) / 8 * 8;
+  }
+
+  // Byte sizes of the payload arrays, in file order
+  auto section_sizes(std::uint64_t rows, std::uint64_t lower_nonzeros, std::uint64_t upper_nonzeros)
+    -> std::array<size_t, 8>
+  {
+    return {
+      padded(rows * sizeof(int)),
+      padded(rows * sizeof(int)),
+      padded((rows + 1) * sizeof(int)),
+      padded(lower_nonzeros * sizeof(int)),
+      lower_nonzeros * sizeof(double),
+      padded((rows + 1) * sizeof(int)),
+      padded(upper_nonzeros * sizeof(int)),
+      upper_nonzeros * sizeof(double),
+    };
+  }
+
+  // Writes the array and pads it to `size` bytes, feeding both to `checksum`
+  void write_section(std::ofstream& file, Checksum& checksum, void const* data, size_t bytes, size_t size)
+  {
+    static constexpr std::array<char, 8> zeros {};
+    file.write(static_cast<char const*>(data), static_cast<std::streamsize>(bytes));
+    file.write(zeros.data(), static_cast<std::streamsize>(size - bytes));
+    checksum.add(data, bytes);
+    checksum.add(zeros.data(), size - bytes);
+  }
+}  // namespace
+
+auto factorization_key(Eigen::SparseMatrix<double> const& matrix) -> std::uint64_t
+{
+  Hash hash;
+  hash.add(static_cast<std::uint64_t>(matrix.rows()));
+  hash.add(static_cast<std::uint64_t>(matrix.cols()));
+  for(Eigen::Index col = 0; col < matrix.outerSize(); ++col) {
+    for(Eigen::SparseMatrix<double>::InnerIterator it(matrix, col); it; ++it) {
+      hash.add(static_cast<std::uint64_t>(it.index()));
+      hash.add(static_cast<std::uint64_t>(col));
+      hash.add(std::bit_cast<std::uint64_t>(it.value()));
+    }
+  }
+  return hash.value();
+}
+
+void save_factorization(std::filesystem::path const& path, std::uint64_t key, LUFactors const& factors)
+{
+  auto const n = factors.lower.rows();
+
+  // clang-format off
+  contract(fun) {
+    precondition(factors.lower.isCompressed() and factors.upper.isCompressed(), "factors must be compressed");
+    precondition(factors.upper.rows() == n and factors.row_permutation.size() == n
+                   and factors.column_permutation.size() == n, "size mismatch");
+  };
+  // clang-format on
+
+  Header header {
+    magic,
+    version,
+    sizeof(int),
+    key,
+    static_cast<std::uint64_t>(n),
+    static_cast<std::uint64_t>(factors.lower.nonZeros()),
+    static_cast<std::uint64_t>(factors.upper.nonZeros()),
+    0
+  };
+
+  auto const sizes = section_sizes(header.rows, header.lower_nonzeros, header.upper_nonzeros);
+  std::array<std::pair<void const*, size_t>, 8> const sections = {{
+    {factors.row_permutation.data(), n * sizeof(int)},
+    {factors.column_permutation.data(), n * sizeof(int)},
+    {factors.lower.outerIndexPtr(), (n + 1) * sizeof(int)},
+    {factors.lower.innerIndexPtr(), header.lower_nonzeros * sizeof(int)},
+    {factors.lower.valuePtr(), header.lower_nonzeros * sizeof(double)},
+    {factors.upper.outerIndexPtr(), (n + 1) * sizeof(int)},
+    {factors.upper.innerIndexPtr(), header.upper_nonzeros * sizeof(int)},
+    {factors.upper.valuePtr(), header.upper_nonzeros * sizeof(double)},
+  }};
+
+  if(path.has_parent_path()) {
+    std::filesystem::create_directories(path.parent_path());
+  }
+
+  auto temporary = path;
+  temporary += ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    // The checksum is known once the payload is written
+    file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+    Checksum checksum;
+    for(size_t section = 0; section < sections.size(); ++section) {
+      write_section(file, checksum, sections[section].first, sections[section].second, sizes[section]);
+    }
+
+    header.checksum = checksum.value();
+    file.seekp(0);
+    file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    if(not file) {
+      throw std::runtime_error("can not write " + temporary.string());
+    }
+  }
+  std::filesystem::rename(temporary, path);
+}
+
+auto StoredFactorization::open(std::filesystem::path const& path, std::uint64_t key)
+  -> std::optional<StoredFactorization>
+{
+  auto const descriptor = ::open(path.c_str(), O_RDONLY);
+  if(descriptor < 0) {
+    return std::nullopt;
+  }
+
+  struct stat status {};
+  void* mapping = MAP_FAILED;
+  if(::fstat(descriptor, &status) == 0 and static_cast<size_t>(status.st_size) >= sizeof(Header)) {
+    mapping = ::mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+  }
+  // The mapping outlives the descriptor
+  ::close(descriptor);
+  if(mapping == MAP_FAILED) {
+    return std::nullopt;
+  }
+
+  StoredFactorization stored;
+  stored.m_mapping = mapping;
+  stored.m_mapping_size = static_cast<size_t>(status.st_size);
+
+  Header header;
+  std::memcpy(&header, mapping, sizeof(header));
+  if(header.magic != magic or header.version != version or header.index_size != sizeof(int)
+     or header.key != key) {
+    return std::nullopt;
+  }
+
+  auto const sizes = section_sizes(header.rows, header.lower_nonzeros, header.upper_nonzeros);
+  size_t payload_size = 0;
+  for(auto const size : sizes) {
+    payload_size += size;
+  }
+  if(stored.m_mapping_size != sizeof(Header) + payload_size) {
+    return std::nullopt;
+  }
+
+  auto const* payload = static_cast<char const*>(mapping) + sizeof(Header);
+  Checksum checksum;
+  checksum.add(payload, payload_size);
+  if(checksum.value() != header.checksum) {
+    return std::nullopt;
+  }
+
+  std::array<char const*, 8> sections {};
+  for(size_t section = 0, offset = 0; section < sections.size(); offset += sizes[section++]) {
+    sections[section] = payload + offset;
+  }
+
+  stored.m_rows = static_cast<Eigen::Index>(header.rows);
+  stored.m_lower_nonzeros = static_cast<Eigen::Index>(header.lower_nonzeros);
+  stored.m_upper_nonzeros = static_cast<Eigen::Index>(header.upper_nonzeros);
+  stored.m_row_permutation = reinterpret_cast<int const*>(sections[0]);
+  stored.m_column_permutation = reinterpret_cast<int const*>(sections[1]);
+  stored.m_lower_outer = reinterpret_cast<int const*>(sections[2]);
+  stored.m_lower_inner = reinterpret_cast<int const*>(sections[3]);
+  stored.m_lower_values = reinterpret_cast<double const*>(sections[4]);
+  stored.m_upper_outer = reinterpret_cast<int const*>(sections[5]);
+  stored.m_upper_inner = reinterpret_cast<int const*>(sections[6]);
+  stored.m_upper_values = reinterpret_cast<double const*>(sections[7]);
+  return stored;
+}
+
+StoredFactorization::StoredFactorization(StoredFactorization&& other) noexcept
+{
+  *this = std::move(other);
+}
+
+auto StoredFactorization::operator=(StoredFactorization&& other) noexcept -> StoredFactorization&
+{
+  if(this != &other) {
+    if(m_mapping != nullptr) {
+      ::munmap(m_mapping, m_mapping_size);
+    }
+    m_mapping = std::exchange(other.m_mapping, nullptr);
+    m_mapping_size = std::exchange(other.m_mapping_size, 0);
+    m_rows = other.m_rows;
+    m_lower_nonzeros = other.m_lower_nonzeros;
+    m_upper_nonzeros = other.m_upper_nonzeros;
+    m_row_permutation = other.m_row_permutation;
+    m_column_permutation = other.m_column_permutation;
+    m_lower_outer = other.m_lower_outer;
+    m_lower_inner = other.m_lower_inner;
+    m_lower_values = other.m_lower_values;
+    m_upper_outer = other.m_upper_outer;
+    m_upper_inner = other.m_upper_inner;
+    m_upper_values = other.m_upper_values;
+  }
+  return *this;
+}
+
+StoredFactorization::~StoredFactorization()
+{
+  if(m_mapping != nullptr) {
+    ::munmap(m_mapping, m_mapping_size);
+  }
+}
+
+auto StoredFactorization::lower() const -> FactorView
+{
+  return {m_rows, m_rows, m_lower_nonzeros, m_lower_outer, m_lower_inner, m_lower_values};
+}
+
+auto StoredFactorization::upper() const -> FactorView
+{
+  return {m_rows, m_rows, m_upper_nonzeros, m_upper_outer, m_upper_inner, m_upper_values};
+}
+
+void StoredFactorization::solve_in_place(
+  Eigen::Ref<Eigen::VectorXd> b,
+  Eigen::Ref<Eigen::VectorXd> workspace
+) const
+{
+  // clang-format off
+  contract(fun) {
+    precondition(b.size() == m_rows, "size mismatch");
+    precondition(workspace.size() == m_rows, "workspace size mismatch");
+  };
+  // clang-format on
+
+  for(Eigen::Index i = 0; i < m_rows; ++i) {
+    workspace(m_row_permutation[i]) = b(i);
+  }
+
+  lower().triangularView<Eigen::UnitLower>().solveInPlace(workspace);
+  upper().triangularView<Eigen::Upper>().solveInPlace(workspace);
+
+  for(Eigen::Index i = 0; i < m_rows; ++i) {
+    b(i) = workspace(m_column_permutation[i]);
+  }
+}
+
+auto StoredFactorization::solve(Eigen::Ref<Eigen::VectorXd const> b) const -> Eigen::VectorXd
+{
+  Eigen::VectorXd x = b;
+  Eigen::VectorXd workspace(m_rows);
+  solve_in_place(x, workspace);
+  return x;
+}
+
+auto factorization_path(std::filesystem::path const& directory, std::uint64_t key)
+  -> std::filesystem::path
+{
+  std::ostringstream name;
+  name << std::hex << std::setw(16) << std::setfill('0') << key << ".lu";
+  return directory / name.str();
+}
+
+auto load_or_factorize(Eigen::SparseMatrix<double> const& matrix, std::filesystem::path const& directory)
+  -> StoredFactorization
+{
+  auto const key = factorization_key(matrix);
+  auto const path = factorization_path(directory, key);
+  if(auto stored = StoredFactorization::open(path, key)) {
+    return std::move(*stored);
+  }
+
+  Eigen::SparseLU<Eigen::SparseMatrix<double>> solver;
+  solver.compute(matrix);
+  if(solver.info() != Eigen::Success) {
+    throw std::runtime_error("can not factorize: " + solver.lastErrorMessage());
+  }
+  save_factorization(path, key, extract_lu_factors(solver));
+
+  if(auto stored = StoredFactorization::open(path, key)) {
+    return std::move(*stored);
+  }
+  throw std::runtime_error("can not read back " + path.string());
+}
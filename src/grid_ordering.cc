@@ -0,0 +1,82 @@
+#include <grid_ordering.hpp>
+
+#include <algorithm>
+#include <bit>
+
+namespace
+{
+  // Leaves of the dissection are small enough for any order
+  constexpr size_t dissection_leaf = 16;
+
+  void dissect(
+    size_t i_begin,
+    size_t i_end,
+    size_t j_begin,
+    size_t j_end,
+    size_t ny,
+    std::vector<size_t>& order
+  )
+  {
+    auto const rows = i_end - i_begin;
+    auto const columns = j_end - j_begin;
+    if(rows == 0 or columns == 0) {
+      return;
+    }
+
+    if(rows * columns <= dissection_leaf or (rows < 3 and columns < 3)) {
+      for(size_t i = i_begin; i < i_end; ++i) {
+        for(size_t j = j_begin; j < j_end; ++j) {
+          order.push_back(i * ny + j);
+        }
+      }
+      return;
+    }
+
+    // Separator across the longer side
+    if(rows >= columns) {
+      auto const middle = i_begin + rows / 2;
+      dissect(i_begin, middle, j_begin, j_end, ny, order);
+      dissect(middle + 1, i_end, j_begin, j_end, ny, order);
+      for(size_t j = j_begin; j < j_end; ++j) {
+        order.push_back(middle * ny + j);
+      }
+    }
+    else {
+      auto const middle = j_begin + columns / 2;
+      dissect(i_begin, i_end, j_begin, middle, ny, order);
+      dissect(i_begin, i_end, middle + 1, j_end, ny, order);
+      for(size_t i = i_begin; i < i_end; ++i) {
+        order.push_back(i * ny + middle);
+      }
+    }
+  }
+}
+
+auto cyclic_reduction_order(size_t nx, size_t ny) -> std::vector<size_t>
+{
+  // Line i is eliminated at the level equal to the number of trailing zeros of i + 1
+  std::vector<size_t> lines(nx);
+  for(size_t i = 0; i < nx; ++i) {
+    lines[i] = i;
+  }
+  std::stable_sort(lines.begin(), lines.end(), [](size_t lhs, size_t rhs) {
+    return std::countr_zero(lhs + 1) < std::countr_zero(rhs + 1);
+  });
+
+  std::vector<size_t> order;
+  order.reserve(nx * ny);
+  for(auto const i : lines) {
+    for(size_t j = 0; j < ny; ++j) {
+      order.push_back(i * ny + j);
+    }
+  }
+  return order;
+}
+
+auto nested_dissection_order(size_t nx, size_t ny) -> std::vector<size_t>
+{
+  std::vector<size_t> order;
+  order.reserve(nx * ny);
+  dissect(0, nx, 0, ny, ny, order);
+  return order;
+}
@@ -1,5 +1,9 @@
 #include <interval_splitter.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
 auto split_interval(double const& left, double const& right, size_t num_intervals) -> std::vector<double>
 {
   std::vector<double> intervals;
@@ -17,6 +21,159 @@ auto split_interval(double const& left, double const& right, size_t num_interval
   return intervals;
 }
 
+namespace
+{
+  // Points at the running sums of `lengths`, scaled to fill [left, right]
+  auto accumulate_lengths(double left, double right, std::vector<double> const& lengths)
+    -> std::vector<double>
+  {
+    double total = 0;
+    for(auto const length : lengths) {
+      total += length;
+    }
+
+    std::vector<double> points {left};
+    double sum = 0;
+    for(size_t i = 0; i + 1 < lengths.size(); ++i) {
+      sum += lengths[i];
+      points.push_back(left + (right - left) * sum / total);
+    }
+    points.push_back(right);
+    return points;
+  }
+}  // namespace
+
+auto split_interval_geometric(
+  double const& left,
+  double const& right,
+  size_t num_intervals,
+  double ratio,
+  GradedEnd end
+) -> std::vector<double>
+{
+  contract(fun)
+  {
+    precondition(num_intervals > 0, "invalid number of intervals");
+    precondition(ratio > 0, "ratio must be positive");
+  };
+
+  // Intervals away from the refined end(s)
+  auto distance = [&](size_t i) -> size_t {
+    switch(end) {
+      case GradedEnd::left:
+        return i;
+      case GradedEnd::right:
+        return num_intervals - 1 - i;
+      case GradedEnd::both:
+        return std::min(i, num_intervals - 1 - i);
+    }
+    return 0;
+  };
+
+  std::vector<double> lengths(num_intervals);
+  for(size_t i = 0; i < num_intervals; ++i) {
+    lengths[i] = std::pow(ratio, double(distance(i)));
+  }
+  return accumulate_lengths(left, right, lengths);
+}
+
+auto split_interval_chebyshev(double const& left, double const& right, size_t num_intervals)
+  -> std::vector<double>
+{
+  contract(fun)
+  {
+    precondition(num_intervals > 0, "invalid number of intervals");
+  };
+
+  std::vector<double> points {left};
+  for(size_t i = 1; i < num_intervals; ++i) {
+    auto const theta = std::numbers::pi * double(i) / double(num_intervals);
+    points.push_back((left + right) / 2 - (right - left) / 2 * std::cos(theta));
+  }
+  points.push_back(right);
+  return points;
+}
+
+auto split_interval_tanh(
+  double const& left,
+  double const& right,
+  size_t num_intervals,
+  double beta,
+  GradedEnd end
+) -> std::vector<double>
+{
+  contract(fun)
+  {
+    precondition(num_intervals > 0, "invalid number of intervals");
+    precondition(beta > 0, "beta must be positive");
+  };
+
+  // Maps s in [0, 1] to [0, 1], flat where the points are to be dense
+  auto stretch = [&](double s) {
+    switch(end) {
+      case GradedEnd::left:
+        return 1 - std::tanh(beta * (1 - s)) / std::tanh(beta);
+      case GradedEnd::right:
+        return std::tanh(beta * s) / std::tanh(beta);
+      case GradedEnd::both:
+        return (1 + std::tanh(beta * (2 * s - 1)) / std::tanh(beta)) / 2;
+    }
+    return s;
+  };
+
+  std::vector<double> points {left};
+  for(size_t i = 1; i < num_intervals; ++i) {
+    points.push_back(left + (right - left) * stretch(double(i) / double(num_intervals)));
+  }
+  points.push_back(right);
+  return points;
+}
+
+auto curvature_indicator(std::span<const double> points, std::span<const double> values)
+  -> std::vector<double>
+{
+  contract(fun)
+  {
+    precondition(points.size() >= 2, "at least one interval is required");
+    precondition(values.size() == points.size(), "size mismatch");
+  };
+
+  // |u''| at the inner points, 0 at the ends
+  std::vector<double> second(points.size(), 0);
+  for(size_t m = 1; m + 1 < points.size(); ++m) {
+    auto const h_left = calc_h(points, m);
+    auto const h_right = calc_h(points, m + 1);
+    auto const slope_left = (values[m] - values[m - 1]) / h_left;
+    auto const slope_right = (values[m + 1] - values[m]) / h_right;
+    second[m] = std::abs(2 * (slope_right - slope_left) / (h_left + h_right));
+  }
+
+  std::vector<double> indicator(points.size() - 1);
+  for(size_t m = 0; m < indicator.size(); ++m) {
+    auto const h = calc_h(points, m + 1);
+    indicator[m] = h * h * std::max(second[m], second[m + 1]) / 8;
+  }
+  return indicator;
+}
+
+auto refine_marked(std::span<const double> points, std::span<const double> indicator, double threshold)
+  -> std::vector<double>
+{
+  contract(fun)
+  {
+    precondition(indicator.size() + 1 == points.size(), "one indicator per interval is required");
+  };
+
+  std::vector<double> refined {points[0]};
+  for(size_t m = 0; m < indicator.size(); ++m) {
+    if(indicator[m] > threshold) {
+      refined.push_back(middle_point(points, m + 1));
+    }
+    refined.push_back(points[m + 1]);
+  }
+  return refined;
+}
+
 // Calculate the length of an interval `index-1` to `index`
 auto calc_h(std::span<const double> points, size_t index) -> double
 {
@@ -1,7 +1,15 @@
+#include <algorithm>
+#include <array>
 #include <iostream>
 #include <iomanip>  // For std::setw, std::fixed, std::setprecision, etc.
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
@@ -11,6 +19,16 @@
 #include <default_impl/main_matrix_calculator.hpp>
 #include <interval_splitter.hpp>
 #include <default_impl/odd_even_reduction.hpp>
+#include <default_impl/main_matrix_calculator_3d.hpp>
+#include <default_impl/nested_cyclic_reduction.hpp>
+#include <matrix_builder.hpp>
+#include <boundary_condensation.hpp>
+#include <padded_grid.hpp>
+#include <adaptive_refinement.hpp>
+#include <factorization_store.hpp>
+#include <batch_evaluation.hpp>
+#include <solve_planner.hpp>
+#include <tuning.hpp>
 #include <utils.hpp>
 
 void print_matrix(const Eigen::MatrixXd& matrix, int width = 10, int precision = 2) {
@@ -22,142 +40,29 @@ void print_matrix(const Eigen::MatrixXd& matrix, int width = 10, int precision =
     }
 }
 
-auto build_main_matrix(DefaultMainMatrixCalculator const& calc) -> Eigen::SparseMatrix<double>
-{
-  size_t Nx = calc.interiour_x_points().size();  // Interior points in x-direction
-  size_t Ny = calc.interiour_y_points().size();  // Interior points in y-direction
-  size_t size = Nx * Ny;  // Total unknowns (interior grid points)
-
-  auto result = Eigen::SparseMatrix<double>(size, size);
-  result.setZero();  // Initialize with zeros
-
-  // Iterate over the interior grid
-  for (size_t i = 0; i < Nx; ++i) {    
-    for (size_t j = 0; j < Ny; ++j) {  
-      size_t idx = i * Ny + j;  // Correct 1D index
-
-      // Left neighbor (i-1, j)
-      if (i > 0) {
-        result.insert(idx, idx - Ny) = calc.calc_d({i, j});
-      }
-
-      // Right neighbor (i+1, j)
-      if (i < Nx - 1) {
-        result.insert(idx, idx + Ny) = calc.calc_e({i, j});
-      }
-
-      // Bottom neighbor (i, j-1)
-      if (j > 0) {
-        result.insert(idx, idx - 1) = calc.calc_a({i, j});
-      }
-
-      // Top neighbor (i, j+1)
-      if (j < Ny - 1) {
-        result.insert(idx, idx + 1) = calc.calc_b({i, j});
-      }
-
-      // Center coefficient
-      result.insert(idx, idx) = calc.calc_c({i, j});
-    }
-  }
-
-  return result;
-}
-
-
-auto build_g_vector(DefaultMainMatrixCalculator const& calc) -> Eigen::VectorXd
-{
-  size_t Nx = calc.interiour_x_points().size();  // Interior points in x-direction
-  size_t Ny = calc.interiour_y_points().size();  // Interior points in y-direction
-  size_t size = Nx * Ny;  // Total number of unknowns
-
-  Eigen::VectorXd g(size);  // Initialize vector of correct size
-
-  // Iterate over interior grid points
-  for (size_t i = 0; i < Nx; ++i) {    
-    for (size_t j = 0; j < Ny; ++j) {  
-      size_t idx = i * Ny + j;  // Convert (i, j) to 1D index
-      g(idx) = calc.calc_g({i, j});  // Compute g at (i, j)
-    }
-  }
-
-  return g;
-}
-
-auto reduce_matrix(DefaultMainMatrixCalculator const& calc, Eigen::MatrixXd const& matrix)
-  -> Eigen::MatrixXd
-{
-  Eigen::MatrixXd reduced_matrix(matrix.rows() - 2, matrix.cols());
-  for(size_t row = 1; row < calc.x_points().size(); ++row) {
-    reduced_matrix.row(
-      row + calc.x_points().size()
-    ) = reduced_matrix.row(row + calc.x_points().size())
-      - matrix.row(row) * (-matrix(row + calc.x_points().size(), row));
-  }
-
-  for(size_t row = matrix.rows() - calc.x_points().size(); row < matrix.rows(); ++row) {
-    reduced_matrix.row(
-      row - calc.x_points().size()
-    ) = reduced_matrix.row(row - calc.x_points().size())
-      - matrix.row(row) * (-matrix(row - calc.x_points().size(), row));
-  }
-
-  return reduced_matrix;
-}
-
-auto convert_w_to_v(Eigen::VectorXd const& w, DefaultMainMatrixCalculator const& calc) -> Eigen::MatrixXd {
-    size_t Nx = calc.interiour_x_points().size();
-    size_t Ny = calc.interiour_y_points().size();
-
-    Eigen::MatrixXd v(Nx + 2, Ny + 2);
-    v.setZero();  // Initialize with zeros
-
-    size_t idx = 0;
-    for (size_t i = 1; i <= Nx; ++i) {  // Skip first & last row (boundaries)
-        for (size_t j = 1; j <= Ny; ++j) {  // Skip first & last column (boundaries)
-            v(i, j) = w(idx++);  // Fill interior solution
-        }
-    }
-
-    auto params = calc.params();
-
-    for (size_t j = 0; j < Ny + 2; ++j) {
-        v(0, j) = params->u1(calc.y_points()[j]);
-    }
-
-    for (size_t j = 0; j < Ny + 2; ++j) {
-        v(Nx + 1, j) = params->u2(calc.y_points()[j]);
-    }
-
-    for (size_t i = 0; i < Nx + 2; ++i) {
-        v(i, 0) = params->u3(calc.x_points()[i]);
-    }
-
-    for (size_t i = 0; i < Nx + 2; ++i) {
-        v(i, Ny + 1) = params->u4(calc.x_points()[i]);
-    }
-
-    return v;
-}
-
-
-void print_expected(DefaultMainMatrixCalculator const& calc, X_Y_Function_type expected_func) {
+void print_expected(DefaultMainMatrixCalculator const& calc, Batch_X_Y_Function_type const& expected_func) {
     const auto& x_points = calc.x_points();  // Full x grid
     const auto& y_points = calc.y_points();  // Full y grid
     size_t Nx = x_points.size();
     size_t Ny = y_points.size();
 
-    // 🔹 Print table header (y-values at top)
-    // 🔹 Print computed values in a grid format
+    // One call per row of the grid
+    std::vector<double> row_x(Ny);
+    std::vector<double> expected_row(Ny);
     for (size_t i = 0; i < Nx; ++i) {
-        for (size_t j = 0; j < Ny; ++j) {
-            double expected_value = expected_func(x_points[i], y_points[j]);  // Compute expected value
+        std::fill(row_x.begin(), row_x.end(), x_points[i]);
+        expected_func(row_x, y_points, expected_row);
+        for (auto const expected_value : expected_row) {
             std::cout << std::setw(10) << std::fixed << std::setprecision(4) << expected_value;
         }
         std::cout << "\n";
     }
 }
 
+void print_expected(DefaultMainMatrixCalculator const& calc, X_Y_Function_type expected_func) {
+    print_expected(calc, batched(std::move(expected_func)));
+}
+
 void _do_all(std::shared_ptr<InputParameters> params, X_Y_Function_type expected_func)
 {
   static constexpr auto x_interval_counts = {4};
@@ -178,13 +83,19 @@ void _do_all(std::shared_ptr<InputParameters> params, X_Y_Function_type expected
       std::cout << "----------------------------------------\n";
       std::cout << "Main matrix size: " << main_matrix.rows() << "x" << main_matrix.cols() << '\n';
       std::cout << "G vector size: " << g_vector.size() << '\n';
-      Eigen::SparseLU<Eigen::SparseMatrix<double>> solver;
-      solver.compute(main_matrix);
-      Eigen::VectorXd solution = solver.solve(g_vector);
-      // Eigen::VectorXd solution = odd_even_reduction_solver(main_matrix, g_vector);
-      std::cout << "Solution: \n" << solution << '\n';
-      auto v_matrix = convert_w_to_v(solution, calc);
-      std::cout << "Solution in v coordinates: \n" << v_matrix << '\n';
+      auto condensed = condense_boundary(calc, main_matrix, g_vector);
+      PaddedGrid v_grid(calc.interiour_x_points().size(), calc.interiour_y_points().size());
+      fill_boundary(sample_boundary(calc), v_grid);
+      // Factors are reused across runs when a store directory is given
+      if(auto const* directory = std::getenv("COURSE_FACTORIZATION_DIR")) {
+        solve_into(load_or_factorize(condensed.matrix, directory), condensed, v_grid);
+      } else {
+        Eigen::SparseLU<Eigen::SparseMatrix<double>> solver;
+        solver.compute(condensed.matrix);
+        solve_into(solver, condensed, v_grid);
+      }
+      std::cout << "Solution: \n" << v_grid.interior() << '\n';
+      std::cout << "Solution in v coordinates: \n" << v_grid.full() << '\n';
       std::cout << "----------------------------------------\n";
       std::cout << "Expected:: \n";
       print_expected(calc, expected_func);
@@ -240,8 +151,352 @@ void basic_example()
   do_all(params, expected_func);
 }
 
-int main()
+void box_example()
+{
+  std::shared_ptr<InputParameters3D> params = std::make_shared<InputParameters3D>();
+  params->xl = 0;
+  params->xr = 1;
+  params->yl = 0;
+  params->yr = 1;
+  params->zl = 0;
+  params->zr = 2;
+
+  params->u0 = [](double x, double y, double z) { return x * x + y * y - 2 * z * z; };
+  params->k = [](double x, double y, double z) { return 1; };
+  params->f = [](double x, double y, double z) { return 0; };
+
+  auto expected_func = [](double x, double y, double z) { return x * x + y * y - 2 * z * z; };
+
+  static constexpr size_t interval_counts[] = {8, 16, 32, 64};
+
+  for(auto const& row : run_box_convergence(params, expected_func, interval_counts)) {
+    std::cout << std::setw(4) << row.intervals << std::setw(20) << row.inaccuracy << std::setw(20)
+              << row.seconds << '\n';
+  }
+}
+
+// Refines the box grid until the estimated error reaches `tolerance`
+void adaptive_example(double tolerance)
+{
+  std::shared_ptr<InputParameters3D> params = std::make_shared<InputParameters3D>();
+  params->xl = 0;
+  params->xr = 1;
+  params->yl = 0;
+  params->yr = 1;
+  params->zl = 0;
+  params->zr = 1;
+
+  auto expected_func = [](double x, double y, double z) { return std::exp(x) * std::sin(y) + z; };
+  params->u0 = expected_func;
+  params->k = [](double x, double y, double z) { return 1; };
+  params->f = [](double x, double y, double z) { return 0; };
+
+  auto result = solve_to_tolerance(params, tolerance);
+
+  std::cout << std::setw(10) << "intervals" << std::setw(12) << "unknowns" << std::setw(20)
+            << "error estimate" << std::setw(10) << "order" << std::setw(16) << "seconds" << '\n';
+  for(auto const& level : result.levels) {
+    std::cout << std::setw(10) << level.intervals << std::setw(12) << level.unknowns << std::setw(20)
+              << level.error_estimate << std::setw(10) << level.order << std::setw(16) << level.seconds
+              << '\n';
+  }
+  // The extrapolated solution lives on the interior points of the coarser of the last two levels
+  auto const x_points = split_interval(params->xl, params->xr, result.intervals);
+  auto const y_points = split_interval(params->yl, params->yr, result.intervals);
+  auto const z_points = split_interval(params->zl, params->zr, result.intervals);
+  double inaccuracy = 0;
+  size_t row = 0;
+  for(size_t i = 1; i < result.intervals; ++i) {
+    for(size_t j = 1; j < result.intervals; ++j) {
+      for(size_t k = 1; k < result.intervals; ++k) {
+        inaccuracy = std::max(
+          inaccuracy, std::abs(result.solution(row++) - expected_func(x_points[i], y_points[j], z_points[k]))
+        );
+      }
+    }
+  }
+
+  std::cout << (result.converged ? "converged" : "max_intervals reached") << ", extrapolated on "
+            << result.intervals << " intervals, inaccuracy " << inaccuracy << '\n';
+}
+
+// Boundary layer exp((x - 1) / 0.02) at the x = 1 face: the same number of x intervals
+// graded towards it, then refined where the curvature indicator is largest until the error
+// estimate reaches `tolerance`
+void graded_example(double tolerance)
 {
+  constexpr double width = 0.02;
+
+  std::shared_ptr<InputParameters3D> params = std::make_shared<InputParameters3D>();
+  params->xl = 0;
+  params->xr = 1;
+  params->yl = 0;
+  params->yr = 1;
+  params->zl = 0;
+  params->zr = 1;
+
+  auto expected_func = [](double x, double y, double z) { return std::exp((x - 1) / width) + y * z; };
+  params->u0 = expected_func;
+  params->k = [](double x, double y, double z) { return 1; };
+  params->f = [](double x, double y, double z) { return -std::exp((x - 1) / width) / (width * width); };
+
+  // max |w - expected| over the interior points
+  auto inaccuracy = [&](DefaultMainMatrixCalculator3D const& calc, Eigen::VectorXd const& w) {
+    auto const x = calc.interiour_x_points();
+    auto const y = calc.interiour_y_points();
+    auto const z = calc.interiour_z_points();
+    double result = 0;
+    size_t row = 0;
+    for(auto const xi : x) {
+      for(auto const yj : y) {
+        for(auto const zk : z) {
+          result = std::max(result, std::abs(w(row++) - expected_func(xi, yj, zk)));
+        }
+      }
+    }
+    return result;
+  };
+
+  auto const y_points = split_interval(params->yl, params->yr, 8);
+  auto const z_points = split_interval(params->zl, params->zr, 8);
+  auto solve = [&](std::string const& grading, std::vector<double> x_points) {
+    DefaultMainMatrixCalculator3D calc(params, std::move(x_points), y_points, z_points);
+    auto const w = seven_point_solver(build_stencil(calc), build_g_vector(calc));
+    std::cout << std::setw(14) << grading << std::setw(12) << calc.x_points().size() - 1 << std::setw(20)
+              << inaccuracy(calc, w) << '\n';
+  };
+
+  std::cout << std::left << std::setw(14) << "grading" << std::setw(12) << "x intervals" << "inaccuracy\n";
+  for(size_t const n : {16, 32, 64, 128, 256}) {
+    solve("uniform", split_interval(params->xl, params->xr, n));
+  }
+  for(size_t const n : {16, 32}) {
+    solve("geometric", split_interval_geometric(params->xl, params->xr, n, std::pow(40.0, 1.0 / n)));
+    solve("chebyshev", split_interval_chebyshev(params->xl, params->xr, n));
+    solve("tanh", split_interval_tanh(params->xl, params->xr, n, 3));
+  }
+
+  auto result = refine_to_indicator(
+    params,
+    split_interval(params->xl, params->xr, 8),
+    y_points,
+    z_points,
+    tolerance
+  );
+
+  std::cout << '\n' << std::setw(14) << "intervals" << std::setw(12) << "unknowns" << std::setw(20)
+            << "error estimate" << "seconds\n";
+  for(auto const& level : result.levels) {
+    std::cout << std::setw(14)
+              << (std::to_string(level.x_intervals) + "x" + std::to_string(level.y_intervals) + "x"
+                  + std::to_string(level.z_intervals))
+              << std::setw(12) << level.unknowns << std::setw(20) << level.error_estimate << level.seconds
+              << '\n';
+  }
+  DefaultMainMatrixCalculator3D calc(params, result.x_points, result.y_points, result.z_points);
+  std::cout << (result.converged ? "converged" : "max_unknowns reached") << ", error estimate "
+            << result.error_estimate << ", inaccuracy " << inaccuracy(calc, result.solution) << '\n';
+}
+
+// Assembly time of the box with `intervals` per axis for every count of assembly threads,
+// best of three runs, speedup against the first count
+void assembly_scaling(size_t intervals, std::vector<size_t> const& thread_counts)
+{
+  std::shared_ptr<InputParameters3D> params = std::make_shared<InputParameters3D>();
+  params->xl = 0;
+  params->xr = 1;
+  params->yl = 0;
+  params->yr = 1;
+  params->zl = 0;
+  params->zr = 1;
+
+  params->u0 = [](double x, double y, double z) { return std::exp(x) * std::sin(y) + z; };
+  params->k = [](double x, double y, double z) { return 1 + x * y * z; };
+  params->f = [](double x, double y, double z) { return std::sin(x + y + z); };
+
+  DefaultMainMatrixCalculator3D calc(
+    params,
+    split_interval(params->xl, params->xr, intervals),
+    split_interval(params->yl, params->yr, intervals),
+    split_interval(params->zl, params->zr, intervals)
+  );
+
+  auto const saved = active_tuning();
+  auto seconds = [](auto&& assemble) {
+    double best = std::numeric_limits<double>::max();
+    for(int run = 0; run < 3; ++run) {
+      auto const start = std::chrono::steady_clock::now();
+      assemble();
+      best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+  };
+
+  std::cout << std::left << std::setw(10) << "threads" << std::setw(14) << "matrix" << std::setw(14) << "g"
+            << std::setw(14) << "stencil" << "speedup\n";
+  double reference = 0;
+  for(auto const threads : thread_counts) {
+    auto tuning = saved;
+    tuning.assembly_threads = threads;
+    set_active_tuning(tuning);
+
+    auto const matrix = seconds([&] { build_main_matrix(calc); });
+    auto const g = seconds([&] { build_g_vector(calc); });
+    auto const stencil = seconds([&] { build_stencil(calc); });
+    auto const total = matrix + g + stencil;
+    if(reference == 0) {
+      reference = total;
+    }
+    std::cout << std::setw(10) << threads << std::setw(14) << matrix << std::setw(14) << g << std::setw(14)
+              << stencil << reference / total << '\n';
+  }
+  set_active_tuning(saved);
+}
+
+// Plans the box solve with `intervals` per axis under `memory_limit`, runs it and logs the
+// outcome so that the next plans are calibrated by it
+void plan_example(std::array<size_t, 3> intervals, SolverKind preferred, size_t memory_limit)
+{
+  std::shared_ptr<InputParameters3D> params = std::make_shared<InputParameters3D>();
+  params->xl = 0;
+  params->xr = 1;
+  params->yl = 0;
+  params->yr = 1;
+  params->zl = 0;
+  params->zr = 1;
+
+  params->u0 = [](double x, double y, double z) { return x * x + y * y - 2 * z * z; };
+  params->k = [](double x, double y, double z) { return 1; };
+  params->f = [](double x, double y, double z) { return 0; };
+
+  DefaultMainMatrixCalculator3D calc(
+    params,
+    split_interval(params->xl, params->xr, intervals[0]),
+    split_interval(params->yl, params->yr, intervals[1]),
+    split_interval(params->zl, params->zr, intervals[2])
+  );
+  auto const shape = grid_shape(calc);
+  auto const traits = problem_traits(build_stencil(calc));
+  std::cout << "separable " << traits.separable << ", symmetric positive definite "
+            << traits.symmetric_positive_definite << '\n';
+
+  std::cout << std::left << std::setw(26) << "solver" << std::setw(16) << "bytes" << "seconds\n";
+  for(auto const solver : all_solvers) {
+    if(applicable(solver, shape, traits)) {
+      auto const estimate = estimate_solve(solver, shape);
+      std::cout << std::setw(26) << solver_name(solver) << std::setw(16) << estimate.memory.total()
+                << estimate.seconds << '\n';
+    }
+  }
+
+  auto const plan = plan_solve(shape, traits, preferred, memory_limit);
+  if(not plan) {
+    std::cout << "no solver fits into " << memory_limit << " bytes\n";
+    return;
+  }
+
+  auto const result = execute_plan(*plan, calc);
+  record_outcome(default_plan_log_path(), result.outcome);
+  std::cout << solver_name(plan->estimate.solver);
+  if(plan->reason == PlanReason::not_applicable) {
+    std::cout << " (" << solver_name(preferred) << " not applicable)";
+  }
+  else if(plan->reason == PlanReason::downgraded) {
+    std::cout << " (downgraded from " << solver_name(preferred) << ")";
+  }
+  std::cout << ": predicted " << result.outcome.predicted_bytes << " bytes, "
+            << result.outcome.predicted_seconds << " s, measured " << result.outcome.actual_bytes
+            << " bytes, " << result.outcome.actual_seconds << " s -> " << default_plan_log_path() << '\n';
+}
+
+int main(int argc, char** argv)
+{
+  // Sweeps the kernel parameters on this host and stores them for the next runs
+  if(argc > 1 and std::string_view(argv[1]) == "--autotune") {
+    static constexpr size_t sizes[] = {63, 1023, 16383};
+    auto tuning = autotune(sizes);
+    save_tuning(default_tuning_path(), cpu_model(), tuning);
+    std::cout << cpu_model() << ": cutoff " << tuning.thomas_cutoff << ", line batch "
+              << tuning.line_batch << ", threads " << tuning.threads << " -> "
+              << default_tuning_path() << '\n';
+    return 0;
+  }
+
+  // Fill-in and factorization time of the grid orderings against COLAMD/AMD
+  if(argc > 1 and std::string_view(argv[1]) == "--compare-orderings") {
+    std::vector<size_t> counts;
+    for(int arg = 2; arg < argc; ++arg) {
+      counts.push_back(std::stoul(argv[arg]));
+    }
+    if(counts.empty()) {
+      counts = {256, 512, 1024, 2048};
+    }
+
+    std::cout << std::left << std::setw(8) << "grid" << std::setw(16) << "factorization"
+              << std::setw(20) << "ordering" << std::setw(16) << "factor nnz" << "seconds\n";
+    for(auto const& row : compare_orderings(counts)) {
+      std::cout << std::setw(8) << row.intervals << std::setw(16) << row.factorization
+                << std::setw(20) << row.ordering;
+      if(row.factorized) {
+        std::cout << std::setw(16) << row.factor_nonzeros << row.seconds << std::endl;
+      }
+      else {
+        std::cout << "out of memory" << std::endl;
+      }
+    }
+    return 0;
+  }
+
+  // Convergence of the seven-point scheme on the box
+  if(argc > 1 and std::string_view(argv[1]) == "--box") {
+    box_example();
+    return 0;
+  }
+
+  if(argc > 1 and std::string_view(argv[1]) == "--adaptive") {
+    adaptive_example(argc > 2 ? std::stod(argv[2]) : 1e-5);
+    return 0;
+  }
+
+  if(argc > 1 and std::string_view(argv[1]) == "--graded") {
+    graded_example(argc > 2 ? std::stod(argv[2]) : 1e-3);
+    return 0;
+  }
+
+  // --assembly-scaling [intervals [threads...]]
+  if(argc > 1 and std::string_view(argv[1]) == "--assembly-scaling") {
+    auto const intervals = argc > 2 ? std::stoul(argv[2]) : size_t(128);
+    std::vector<size_t> thread_counts;
+    for(int arg = 3; arg < argc; ++arg) {
+      thread_counts.push_back(std::stoul(argv[arg]));
+    }
+    if(thread_counts.empty()) {
+      for(size_t threads = 1; threads < default_assembly_threads(); threads *= 2) {
+        thread_counts.push_back(threads);
+      }
+      thread_counts.push_back(default_assembly_threads());
+    }
+    assembly_scaling(intervals, thread_counts);
+    return 0;
+  }
+
+  // --plan nx ny nz [solver [limit MiB]]
+  if(argc > 4 and std::string_view(argv[1]) == "--plan") {
+    std::array<size_t, 3> intervals {std::stoul(argv[2]), std::stoul(argv[3]), std::stoul(argv[4])};
+    if(std::ranges::any_of(intervals, [](size_t count) { return count < 2; })) {
+      std::cerr << "every axis needs at least 2 intervals\n";
+      return 1;
+    }
+    auto preferred = argc > 5 ? parse_solver(argv[5]) : SolverKind::sparse_lu;
+    if(not preferred) {
+      std::cerr << "unknown solver " << argv[5] << '\n';
+      return 1;
+    }
+    auto const memory_limit = argc > 6 ? std::stoul(argv[6]) << 20 : available_memory();
+    plan_example(intervals, *preferred, memory_limit);
+    return 0;
+  }
+
   first_example();
   return 0;
 }
@@ -0,0 +1,233 @@
+#include <matrix_builder.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include <contract/contract.hpp>
+
+#include <parallel.hpp>
+#include <tuning.hpp>
+
+auto grid_shape(IMainMatrixCalculator const& calc) -> GridShape
+{
+  // Planar calculators have no z points and a single layer of unknowns
+  return {
+    calc.interiour_x_points().size(),
+    calc.interiour_y_points().size(),
+    calc.z_points().empty() ? 1 : calc.interiour_z_points().size()
+  };
+}
+
+namespace
+{
+  // Planes handed to one task, a few tasks per thread keep them balanced
+  auto plane_batch(GridShape const& shape, size_t threads) -> size_t
+  {
+    return std::max<size_t>(shape.nx / (4 * threads), 1);
+  }
+
+  // Stored entries of column (i, j, k), the pattern is symmetric
+  auto column_nonzeros(GridShape const& shape, size_t i, size_t j, size_t k) -> size_t
+  {
+    return 1 + (i > 0) + (i + 1 < shape.nx) + (j > 0) + (j + 1 < shape.ny) + (k > 0) + (k + 1 < shape.nz);
+  }
+}  // namespace
+
+auto build_main_matrix(IMainMatrixCalculator const& calc) -> Eigen::SparseMatrix<double>
+{
+  auto const shape = grid_shape(calc);
+  size_t Nx = shape.nx;  // Interior points in x-direction
+  size_t Ny = shape.ny;  // Interior points in y-direction
+  size_t Nz = shape.nz;  // Interior points in z-direction
+  size_t size = shape.size();  // Total unknowns (interior grid points)
+  auto const plane = Ny * Nz;
+
+  auto const threads = active_tuning().assembly_threads;
+  auto const batch = plane_batch(shape, threads);
+  auto const batches = (Nx + batch - 1) / batch;
+
+  // Every batch of planes owns its columns, so it can write them in place once the
+  // entries of the batches before it are counted
+  std::vector<size_t> batch_offsets(batches + 1, 0);
+  parallel_for(Nx, batch, threads, [&](size_t begin, size_t end) {
+    size_t nonzeros = 0;
+    for (size_t i = begin; i < end; ++i) {
+      for (size_t j = 0; j < Ny; ++j) {
+        for (size_t k = 0; k < Nz; ++k) {
+          nonzeros += column_nonzeros(shape, i, j, k);
+        }
+      }
+    }
+    batch_offsets[begin / batch + 1] = nonzeros;
+  });
+  std::partial_sum(batch_offsets.begin(), batch_offsets.end(), batch_offsets.begin());
+
+  auto result = Eigen::SparseMatrix<double>(size, size);
+  result.resizeNonZeros(static_cast<Eigen::Index>(batch_offsets.back()));
+  auto* outer = result.outerIndexPtr();
+  auto* inner = result.innerIndexPtr();
+  auto* values = result.valuePtr();
+  outer[size] = static_cast<int>(batch_offsets.back());
+
+  // Column idx gathers the couplings of its neighbours to it, rows ascending
+  parallel_for(Nx, batch, threads, [&](size_t begin, size_t end) {
+    auto position = batch_offsets[begin / batch];
+    auto put = [&](size_t row, double value) {
+      inner[position] = static_cast<int>(row);
+      values[position] = value;
+      ++position;
+    };
+
+    for (size_t i = begin; i < end; ++i) {
+      for (size_t j = 0; j < Ny; ++j) {
+        for (size_t k = 0; k < Nz; ++k) {
+          size_t idx = shape.index({i, j, k});
+          outer[idx] = static_cast<int>(position);
+
+          // Left neighbor (i-1, j, k) couples to its right one
+          if (i > 0) {
+            put(idx - plane, calc.calc_e({i - 1, j, k}));
+          }
+
+          // Bottom neighbor (i, j-1, k)
+          if (j > 0) {
+            put(idx - Nz, calc.calc_b({i, j - 1, k}));
+          }
+
+          // Back neighbor (i, j, k-1)
+          if (k > 0) {
+            put(idx - 1, calc.calc_q({i, j, k - 1}));
+          }
+
+          // Center coefficient
+          put(idx, calc.calc_c({i, j, k}));
+
+          // Front neighbor (i, j, k+1)
+          if (k < Nz - 1) {
+            put(idx + 1, calc.calc_p({i, j, k + 1}));
+          }
+
+          // Top neighbor (i, j+1, k)
+          if (j < Ny - 1) {
+            put(idx + Nz, calc.calc_a({i, j + 1, k}));
+          }
+
+          // Right neighbor (i+1, j, k)
+          if (i < Nx - 1) {
+            put(idx + plane, calc.calc_d({i + 1, j, k}));
+          }
+        }
+      }
+    }
+  });
+
+  return result;
+}
+
+auto build_g_vector(IMainMatrixCalculator const& calc) -> Eigen::VectorXd
+{
+  auto const shape = grid_shape(calc);
+  auto const plane = shape.ny * shape.nz;
+  auto const threads = active_tuning().assembly_threads;
+
+  Eigen::VectorXd g(shape.size());
+  calc.calc_g_edges({g.data(), shape.size()});
+  parallel_for(shape.nx, plane_batch(shape, threads), threads, [&](size_t begin, size_t end) {
+    calc.calc_g_planes(begin, end, {g.data() + begin * plane, (end - begin) * plane});
+  });
+  return g;
+}
+
+auto build_stencil(IMainMatrixCalculator const& calc) -> Stencil7
+{
+  auto const shape = grid_shape(calc);
+  auto const size = static_cast<Eigen::Index>(shape.size());
+  auto const threads = active_tuning().assembly_threads;
+
+  Stencil7 stencil {
+    shape,
+    Eigen::VectorXd::Zero(size),
+    Eigen::VectorXd::Zero(size),
+    Eigen::VectorXd::Zero(size),
+    Eigen::VectorXd::Zero(size),
+    Eigen::VectorXd::Zero(size),
+    Eigen::VectorXd::Zero(size),
+    Eigen::VectorXd::Zero(size)
+  };
+
+  parallel_for(shape.nx, plane_batch(shape, threads), threads, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      for (size_t j = 0; j < shape.ny; ++j) {
+        for (size_t k = 0; k < shape.nz; ++k) {
+          Index index {i, j, k};
+          auto const idx = shape.index(index);
+
+          stencil.c(idx) = calc.calc_c(index);
+          if (i > 0) {
+            stencil.d(idx) = calc.calc_d(index);
+          }
+          if (i < shape.nx - 1) {
+            stencil.e(idx) = calc.calc_e(index);
+          }
+          if (j > 0) {
+            stencil.a(idx) = calc.calc_a(index);
+          }
+          if (j < shape.ny - 1) {
+            stencil.b(idx) = calc.calc_b(index);
+          }
+          if (k > 0) {
+            stencil.p(idx) = calc.calc_p(index);
+          }
+          if (k < shape.nz - 1) {
+            stencil.q(idx) = calc.calc_q(index);
+          }
+        }
+      }
+    }
+  });
+
+  return stencil;
+}
+
+auto apply_stencil(Stencil7 const& stencil, Eigen::VectorXd const& w) -> Eigen::VectorXd
+{
+  auto const& shape = stencil.shape;
+
+  // clang-format off
+  contract(fun) {
+    precondition(static_cast<size_t>(w.size()) == shape.size(), "size mismatch");
+  };
+  // clang-format on
+
+  auto const plane = shape.ny * shape.nz;
+  Eigen::VectorXd result = stencil.c.cwiseProduct(w);
+
+  for (size_t i = 0; i < shape.nx; ++i) {
+    for (size_t j = 0; j < shape.ny; ++j) {
+      for (size_t k = 0; k < shape.nz; ++k) {
+        auto const idx = shape.index({i, j, k});
+        if (i > 0) {
+          result(idx) += stencil.d(idx) * w(idx - plane);
+        }
+        if (i < shape.nx - 1) {
+          result(idx) += stencil.e(idx) * w(idx + plane);
+        }
+        if (j > 0) {
+          result(idx) += stencil.a(idx) * w(idx - shape.nz);
+        }
+        if (j < shape.ny - 1) {
+          result(idx) += stencil.b(idx) * w(idx + shape.nz);
+        }
+        if (k > 0) {
+          result(idx) += stencil.p(idx) * w(idx - 1);
+        }
+        if (k < shape.nz - 1) {
+          result(idx) += stencil.q(idx) * w(idx + 1);
+        }
+      }
+    }
+  }
+
+  return result;
+}
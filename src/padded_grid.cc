@@ -0,0 +1,90 @@
+#include <padded_grid.hpp>
+
+#include <contract/contract.hpp>
+
+#include <batch_evaluation.hpp>
+
+namespace
+{
+  // Copies `values` to the unknowns `numbers`, which ascend as condense_boundary lists them.
+  // Every run of consecutive numbers inside one x = const row is copied as one segment.
+  void store_rows(
+    std::vector<size_t> const& numbers,
+    Eigen::Ref<Eigen::VectorXd const> values,
+    PaddedGrid& grid
+  )
+  {
+    auto const ny = grid.ny();
+    size_t row = 0;
+    size_t row_begin = 0;  // number of the unknown in column 0 of `row`
+
+    for(size_t n = 0; n < numbers.size();) {
+      while(numbers[n] >= row_begin + ny) {
+        ++row;
+        row_begin += ny;
+      }
+
+      auto const column = numbers[n] - row_begin;
+      size_t length = 1;
+      while(n + length < numbers.size() and column + length < ny
+            and numbers[n + length] == numbers[n] + length) {
+        ++length;
+      }
+
+      auto const segment = static_cast<Eigen::Index>(length);
+      grid.interior_row(row).segment(static_cast<Eigen::Index>(column), segment) =
+        values.segment(static_cast<Eigen::Index>(n), segment);
+      n += length;
+    }
+  }
+}  // namespace
+
+void store_condensed(CondensedSystem const& system, Eigen::Ref<Eigen::VectorXd const> w, PaddedGrid& grid)
+{
+  // clang-format off
+  contract(fun) {
+    precondition(static_cast<size_t>(w.size()) == system.kept.size(), "size mismatch");
+    precondition(system.kept.size() + system.eliminated.size() == grid.nx() * grid.ny(), "size mismatch");
+  };
+  // clang-format on
+
+  store_rows(system.kept, w, grid);
+  store_rows(system.eliminated, system.boundary_values, grid);
+}
+
+auto sample_boundary(DefaultMainMatrixCalculator const& calc) -> BoundarySamples
+{
+  auto const& params = calc.params();
+  auto const& x_points = calc.x_points();
+  auto const& y_points = calc.y_points();
+
+  BoundarySamples samples {
+    Eigen::VectorXd(y_points.size()),
+    Eigen::VectorXd(y_points.size()),
+    Eigen::VectorXd(x_points.size()),
+    Eigen::VectorXd(x_points.size())
+  };
+
+  evaluate(params->u1_batch, params->u1, y_points, {samples.u1.data(), y_points.size()});
+  evaluate(params->u2_batch, params->u2, y_points, {samples.u2.data(), y_points.size()});
+  evaluate(params->u3_batch, params->u3, x_points, {samples.u3.data(), x_points.size()});
+  evaluate(params->u4_batch, params->u4, x_points, {samples.u4.data(), x_points.size()});
+
+  return samples;
+}
+
+void fill_boundary(BoundarySamples const& samples, PaddedGrid& grid)
+{
+  // clang-format off
+  contract(fun) {
+    precondition(static_cast<size_t>(samples.u1.size()) == grid.ny() + 2, "size mismatch");
+    precondition(static_cast<size_t>(samples.u3.size()) == grid.nx() + 2, "size mismatch");
+  };
+  // clang-format on
+
+  auto v = grid.full();
+  v.row(0) = samples.u1.transpose();
+  v.row(v.rows() - 1) = samples.u2.transpose();
+  v.col(0) = samples.u3;
+  v.col(v.cols() - 1) = samples.u4;
+}
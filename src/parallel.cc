@@ -0,0 +1,142 @@
+#include <parallel.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  // Workers wait for the next task between calls, so a parallel_for costs a wake-up instead
+  // of starting and joining threads. Threads are started when a call needs more of them.
+  class WorkerPool
+  {
+   public:
+    ~WorkerPool()
+    {
+      {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+      }
+      m_wake.notify_all();
+      for(auto& thread : m_threads) {
+        thread.join();
+      }
+    }
+
+    // Runs `task` on `helpers` workers and on the calling thread, returns once all are done
+    void run(size_t helpers, std::function<void()> const& task)
+    {
+      std::unique_lock lock(m_mutex);
+      while(m_threads.size() < helpers) {
+        m_threads.emplace_back([this, index = m_threads.size(), seen = m_generation] { work(index, seen); });
+      }
+      m_task = &task;
+      m_helpers = helpers;
+      m_running = helpers;
+      ++m_generation;
+      lock.unlock();
+      m_wake.notify_all();
+
+      task();
+
+      lock.lock();
+      m_done.wait(lock, [&] { return m_running == 0; });
+      m_task = nullptr;
+    }
+
+    // Set while a call uses the pool, other calls (nested or from other threads) run inline
+    std::atomic_flag busy;
+
+   private:
+    void work(size_t index, size_t seen)
+    {
+      std::unique_lock lock(m_mutex);
+      while(true) {
+        m_wake.wait(lock, [&] { return m_stopping or m_generation != seen; });
+        if(m_stopping) {
+          return;
+        }
+        seen = m_generation;
+        if(index >= m_helpers) {
+          continue;
+        }
+
+        auto const* task = m_task;
+        lock.unlock();
+        (*task)();
+        lock.lock();
+        if(--m_running == 0) {
+          m_done.notify_one();
+        }
+      }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    std::vector<std::thread> m_threads;
+
+    std::function<void()> const* m_task = nullptr;
+    size_t m_helpers = 0;
+    size_t m_running = 0;
+    size_t m_generation = 0;
+    bool m_stopping = false;
+  };
+
+  auto worker_pool() -> WorkerPool&
+  {
+    static WorkerPool pool;
+    return pool;
+  }
+}  // namespace
+
+void parallel_for(
+  size_t count,
+  size_t batch,
+  size_t threads,
+  std::function<void(size_t begin, size_t end)> const& body
+)
+{
+  batch = std::max<size_t>(batch, 1);
+  auto const batches = (count + batch - 1) / batch;
+  threads = std::clamp<size_t>(threads, 1, std::max<size_t>(batches, 1));
+
+  auto& pool = worker_pool();
+  if(threads == 1 or pool.busy.test_and_set()) {
+    for(size_t begin = 0; begin < count; begin += batch) {
+      body(begin, std::min(begin + batch, count));
+    }
+    return;
+  }
+
+  // Batches are handed out one by one, so uneven batches do not stall a thread
+  std::atomic<size_t> next = 0;
+  std::exception_ptr error;
+  std::atomic_flag error_set;
+
+  std::function<void()> const worker = [&] {
+    try {
+      for(size_t current = next++; current < batches; current = next++) {
+        auto const begin = current * batch;
+        body(begin, std::min(begin + batch, count));
+      }
+    }
+    catch(...) {
+      if(not error_set.test_and_set()) {
+        error = std::current_exception();
+      }
+      next = batches;
+    }
+  };
+
+  pool.run(threads - 1, worker);
+  pool.busy.clear();
+
+  if(error) {
+    std::rethrow_exception(error);
+  }
+}
@@ -0,0 +1,572 @@
+// Python extension module `course`.
+// Arrays are taken through the buffer protocol and results are returned as `course.Vector`,
+// which exports its storage the same way, so numpy.asarray() on either side does not copy.
+// Solvers run with the GIL released, Python callbacks take it back for the call only.
+// They read the process-wide active_tuning(), which is loaded once and can not be changed
+// from Python, so concurrent calls from several Python threads all see the same tuning.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <exception>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <default_impl/main_matrix_calculator_3d.hpp>
+#include <default_impl/nested_cyclic_reduction.hpp>
+#include <default_impl/odd_even_reduction.hpp>
+#include <matrix_builder.hpp>
+#include <utils.hpp>
+
+namespace
+{
+  // Python error is already set, it only has to be propagated
+  struct PythonError : std::exception
+  {};
+
+  // Py_buffer of one dimensional double data, released on destruction
+  class Buffer
+  {
+   public:
+    Buffer() = default;
+    Buffer(Buffer const&) = delete;
+    auto operator=(Buffer const&) -> Buffer& = delete;
+
+    ~Buffer()
+    {
+      if(m_acquired) {
+        PyBuffer_Release(&m_view);
+      }
+    }
+
+    auto acquire(PyObject* object, bool writable) -> bool
+    {
+      auto const flags = PyBUF_STRIDES | PyBUF_FORMAT | (writable ? PyBUF_WRITABLE : 0);
+      if(PyObject_GetBuffer(object, &m_view, flags) != 0) {
+        return false;
+      }
+      m_acquired = true;
+
+      if(m_view.ndim != 1 or m_view.format == nullptr or m_view.format[0] != 'd'
+         or m_view.format[1] != '\0') {
+        PyErr_SetString(PyExc_TypeError, "expected a one dimensional float64 array");
+        return false;
+      }
+      if(m_view.strides[0] <= 0 or m_view.strides[0] % sizeof(double) != 0) {
+        PyErr_SetString(PyExc_ValueError, "unsupported array stride");
+        return false;
+      }
+      return true;
+    }
+
+    auto size() const -> Eigen::Index { return m_view.shape[0]; }
+
+    auto contiguous() const -> bool { return m_view.strides[0] == sizeof(double); }
+
+    auto strided() -> Eigen::Map<Eigen::VectorXd, 0, Eigen::InnerStride<>>
+    {
+      return {static_cast<double*>(m_view.buf), size(), Eigen::InnerStride<>(stride())};
+    }
+
+    auto dense() -> Eigen::Map<Eigen::VectorXd>
+    {
+      return {static_cast<double*>(m_view.buf), size()};
+    }
+
+   private:
+    auto stride() const -> Eigen::Index { return m_view.strides[0] / sizeof(double); }
+
+    Py_buffer m_view {};
+    bool m_acquired = false;
+  };
+
+  // Wraps a Python callable, the GIL is taken for the duration of the call
+  auto wrap_callable(PyObject* callable) -> X_Y_Z_Function_type
+  {
+    auto holder = std::shared_ptr<PyObject>(callable, [](PyObject* object) {
+      auto const state = PyGILState_Ensure();
+      Py_DECREF(object);
+      PyGILState_Release(state);
+    });
+    Py_INCREF(callable);
+
+    return [holder](double x, double y, double z) {
+      auto const state = PyGILState_Ensure();
+      PyObject* result = PyObject_CallFunction(holder.get(), "ddd", x, y, z);
+      double value = result != nullptr ? PyFloat_AsDouble(result) : -1;
+      Py_XDECREF(result);
+      bool const failed = PyErr_Occurred() != nullptr;
+      PyGILState_Release(state);
+
+      if(failed) {
+        throw PythonError();
+      }
+      return value;
+    };
+  }
+
+  // Runs `work` without the GIL and turns C++ exceptions into Python ones
+  template<typename Work>
+  auto without_gil(Work&& work) -> bool
+  {
+    std::exception_ptr error;
+    Py_BEGIN_ALLOW_THREADS
+    try {
+      work();
+    }
+    catch(...) {
+      error = std::current_exception();
+    }
+    Py_END_ALLOW_THREADS
+
+    if(not error) {
+      return true;
+    }
+
+    try {
+      std::rethrow_exception(error);
+    }
+    catch(PythonError const&) {
+    }
+    catch(std::bad_alloc const&) {
+      PyErr_NoMemory();
+    }
+    catch(std::exception const& exception) {
+      PyErr_SetString(PyExc_ValueError, exception.what());
+    }
+    catch(...) {
+      PyErr_SetString(PyExc_RuntimeError, "unknown C++ exception");
+    }
+    return false;
+  }
+
+  // course.Vector ---------------------------------------------------------------------------
+
+  struct VectorObject
+  {
+    PyObject_HEAD
+    Eigen::VectorXd owned;
+    double* data;
+    Py_ssize_t size;
+    // Object owning `data` when it is not `owned`
+    PyObject* base;
+    Py_ssize_t shape[1];
+    Py_ssize_t strides[1];
+  };
+
+  PyTypeObject VectorType = {PyVarObject_HEAD_INIT(nullptr, 0)};
+
+  auto vector_get_buffer(PyObject* self, Py_buffer* view, int flags) -> int
+  {
+    auto* vector = reinterpret_cast<VectorObject*>(self);
+    vector->shape[0] = vector->size;
+    vector->strides[0] = sizeof(double);
+
+    view->obj = Py_NewRef(self);
+    view->buf = vector->data;
+    view->len = vector->size * static_cast<Py_ssize_t>(sizeof(double));
+    view->readonly = 0;
+    view->itemsize = sizeof(double);
+    view->format = (flags & PyBUF_FORMAT) ? const_cast<char*>("d") : nullptr;
+    view->ndim = 1;
+    view->shape = (flags & PyBUF_ND) ? vector->shape : nullptr;
+    view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? vector->strides : nullptr;
+    view->suboffsets = nullptr;
+    view->internal = nullptr;
+    return 0;
+  }
+
+  PyBufferProcs vector_buffer_procs = {vector_get_buffer, nullptr};
+
+  void vector_dealloc(PyObject* self)
+  {
+    auto* vector = reinterpret_cast<VectorObject*>(self);
+    std::destroy_at(&vector->owned);
+    Py_XDECREF(vector->base);
+    Py_TYPE(self)->tp_free(self);
+  }
+
+  auto vector_length(PyObject* self) -> Py_ssize_t
+  {
+    return reinterpret_cast<VectorObject*>(self)->size;
+  }
+
+  PySequenceMethods vector_sequence = {vector_length};
+
+  auto make_vector(Eigen::VectorXd values) -> PyObject*
+  {
+    auto* vector = PyObject_New(VectorObject, &VectorType);
+    if(vector == nullptr) {
+      return nullptr;
+    }
+    new(&vector->owned) Eigen::VectorXd(std::move(values));
+    vector->data = vector->owned.data();
+    vector->size = vector->owned.size();
+    vector->base = nullptr;
+    return reinterpret_cast<PyObject*>(vector);
+  }
+
+  auto make_view(Eigen::VectorXd& values, PyObject* base) -> PyObject*
+  {
+    auto* vector = PyObject_New(VectorObject, &VectorType);
+    if(vector == nullptr) {
+      return nullptr;
+    }
+    new(&vector->owned) Eigen::VectorXd();
+    vector->data = values.data();
+    vector->size = values.size();
+    vector->base = Py_NewRef(base);
+    return reinterpret_cast<PyObject*>(vector);
+  }
+
+  // course.Stencil --------------------------------------------------------------------------
+
+  struct StencilObject
+  {
+    PyObject_HEAD
+    Stencil7 stencil;
+  };
+
+  PyTypeObject StencilType = {PyVarObject_HEAD_INIT(nullptr, 0)};
+
+  void stencil_dealloc(PyObject* self)
+  {
+    std::destroy_at(&reinterpret_cast<StencilObject*>(self)->stencil);
+    Py_TYPE(self)->tp_free(self);
+  }
+
+  auto make_stencil(Stencil7 stencil) -> PyObject*
+  {
+    auto* object = PyObject_New(StencilObject, &StencilType);
+    if(object == nullptr) {
+      return nullptr;
+    }
+    new(&object->stencil) Stencil7(std::move(stencil));
+    return reinterpret_cast<PyObject*>(object);
+  }
+
+  auto stencil_shape(PyObject* self, void*) -> PyObject*
+  {
+    auto const& shape = reinterpret_cast<StencilObject*>(self)->stencil.shape;
+    return Py_BuildValue("(nnn)", shape.nx, shape.ny, shape.nz);
+  }
+
+  // Coefficient views share the stencil storage
+  template<Eigen::VectorXd Stencil7::*member>
+  auto stencil_coefficient(PyObject* self, void*) -> PyObject*
+  {
+    auto& stencil = reinterpret_cast<StencilObject*>(self)->stencil;
+    return make_view(stencil.*member, self);
+  }
+
+  PyGetSetDef stencil_getset[] = {
+    {"shape", stencil_shape, nullptr, "(nx, ny, nz)", nullptr},
+    {"a", stencil_coefficient<&Stencil7::a>, nullptr, "(i, j - 1, k) coupling", nullptr},
+    {"b", stencil_coefficient<&Stencil7::b>, nullptr, "(i, j + 1, k) coupling", nullptr},
+    {"c", stencil_coefficient<&Stencil7::c>, nullptr, "diagonal", nullptr},
+    {"d", stencil_coefficient<&Stencil7::d>, nullptr, "(i - 1, j, k) coupling", nullptr},
+    {"e", stencil_coefficient<&Stencil7::e>, nullptr, "(i + 1, j, k) coupling", nullptr},
+    {"p", stencil_coefficient<&Stencil7::p>, nullptr, "(i, j, k - 1) coupling", nullptr},
+    {"q", stencil_coefficient<&Stencil7::q>, nullptr, "(i, j, k + 1) coupling", nullptr},
+    {nullptr}
+  };
+
+  // Module functions ------------------------------------------------------------------------
+
+  auto tridiagonal_solve(PyObject*, PyObject* args) -> PyObject*
+  {
+    PyObject *a_object, *b_object, *c_object, *rhs_object;
+    if(not PyArg_ParseTuple(args, "OOOO", &a_object, &b_object, &c_object, &rhs_object)) {
+      return nullptr;
+    }
+
+    Buffer a, b, c, rhs;
+    if(not a.acquire(a_object, false) or not b.acquire(b_object, false)
+       or not c.acquire(c_object, false) or not rhs.acquire(rhs_object, true)) {
+      return nullptr;
+    }
+
+    // The solver's preconditions terminate the process, mismatches have to be caught here
+    if(a.size() != rhs.size() or b.size() != rhs.size() or c.size() != rhs.size()) {
+      PyErr_SetString(PyExc_ValueError, "a, b and c must have the size of rhs");
+      return nullptr;
+    }
+
+    bool const solved = without_gil([&] {
+      Eigen::VectorXd workspace(odd_even_reduction_workspace_size(rhs.size()));
+      odd_even_reduction_solve(a.strided(), b.strided(), c.strided(), rhs.strided(), workspace);
+    });
+    if(not solved) {
+      return nullptr;
+    }
+
+    Py_RETURN_NONE;
+  }
+
+  auto stencil_from_arrays(PyObject*, PyObject* args) -> PyObject*
+  {
+    Py_ssize_t nx, ny, nz;
+    PyObject* objects[7];
+    if(not PyArg_ParseTuple(
+         args,
+         "(nnn)OOOOOOO",
+         &nx,
+         &ny,
+         &nz,
+         &objects[0],
+         &objects[1],
+         &objects[2],
+         &objects[3],
+         &objects[4],
+         &objects[5],
+         &objects[6]
+       )) {
+      return nullptr;
+    }
+    if(nx < 0 or ny < 0 or nz < 1) {
+      PyErr_SetString(PyExc_ValueError, "invalid shape");
+      return nullptr;
+    }
+
+    GridShape const shape {size_t(nx), size_t(ny), size_t(nz)};
+    Stencil7 stencil {shape};
+    Eigen::VectorXd* members[] = {
+      &stencil.a, &stencil.b, &stencil.c, &stencil.d, &stencil.e, &stencil.p, &stencil.q
+    };
+
+    for(size_t n = 0; n < 7; ++n) {
+      Buffer buffer;
+      if(not buffer.acquire(objects[n], false)) {
+        return nullptr;
+      }
+      if(static_cast<size_t>(buffer.size()) != shape.size()) {
+        PyErr_SetString(PyExc_ValueError, "coefficient size does not match the shape");
+        return nullptr;
+      }
+      *members[n] = buffer.strided();
+    }
+
+    return make_stencil(std::move(stencil));
+  }
+
+  auto assemble_box(PyObject*, PyObject* args) -> PyObject*
+  {
+    PyObject *x_object, *y_object, *z_object, *u0, *k, *f;
+    if(not PyArg_ParseTuple(args, "OOOOOO", &x_object, &y_object, &z_object, &u0, &k, &f)) {
+      return nullptr;
+    }
+
+    Buffer x, y, z;
+    if(not x.acquire(x_object, false) or not y.acquire(y_object, false)
+       or not z.acquire(z_object, false)) {
+      return nullptr;
+    }
+
+    // Both ends of every axis are boundary points, at least one interior point is required
+    if(x.size() < 3 or y.size() < 3 or z.size() < 3) {
+      PyErr_SetString(PyExc_ValueError, "every axis needs at least 3 points");
+      return nullptr;
+    }
+
+    auto to_points = [](Buffer& buffer) {
+      auto view = buffer.strided();
+      return std::vector<double>(view.begin(), view.end());
+    };
+
+    auto params = std::make_shared<InputParameters3D>();
+    params->u0 = wrap_callable(u0);
+    params->k = wrap_callable(k);
+    params->f = wrap_callable(f);
+
+    Stencil7 stencil;
+    Eigen::VectorXd g;
+    bool const assembled = without_gil([&] {
+      DefaultMainMatrixCalculator3D calc(params, to_points(x), to_points(y), to_points(z));
+      stencil = build_stencil(calc);
+      g = build_g_vector(calc);
+    });
+    if(not assembled) {
+      return nullptr;
+    }
+
+    PyObject* stencil_object = make_stencil(std::move(stencil));
+    PyObject* g_object = make_vector(std::move(g));
+    if(stencil_object == nullptr or g_object == nullptr) {
+      Py_XDECREF(stencil_object);
+      Py_XDECREF(g_object);
+      return nullptr;
+    }
+    return Py_BuildValue("(NN)", stencil_object, g_object);
+  }
+
+  auto solve(PyObject*, PyObject* args) -> PyObject*
+  {
+    PyObject *stencil_object, *g_object;
+    if(not PyArg_ParseTuple(args, "O!O", &StencilType, &stencil_object, &g_object)) {
+      return nullptr;
+    }
+
+    Buffer g;
+    if(not g.acquire(g_object, false)) {
+      return nullptr;
+    }
+
+    auto const& stencil = reinterpret_cast<StencilObject*>(stencil_object)->stencil;
+    if(static_cast<size_t>(g.size()) != stencil.shape.size()) {
+      PyErr_SetString(PyExc_ValueError, "right side size does not match the stencil");
+      return nullptr;
+    }
+
+    Eigen::VectorXd w;
+    bool const solved = without_gil([&] {
+      if(g.contiguous()) {
+        w = seven_point_solver(stencil, g.dense());
+      }
+      else {
+        w = seven_point_solver(stencil, g.strided());
+      }
+    });
+    if(not solved) {
+      return nullptr;
+    }
+
+    return make_vector(std::move(w));
+  }
+
+  auto run_convergence(PyObject*, PyObject* args) -> PyObject*
+  {
+    auto params = std::make_shared<InputParameters3D>();
+    PyObject *u0, *k, *f, *expected, *counts_object;
+    if(not PyArg_ParseTuple(
+         args,
+         "(dddddd)OOOOO",
+         &params->xl,
+         &params->xr,
+         &params->yl,
+         &params->yr,
+         &params->zl,
+         &params->zr,
+         &u0,
+         &k,
+         &f,
+         &expected,
+         &counts_object
+       )) {
+      return nullptr;
+    }
+
+    std::vector<size_t> counts;
+    PyObject* iterator = PyObject_GetIter(counts_object);
+    if(iterator == nullptr) {
+      return nullptr;
+    }
+    while(PyObject* item = PyIter_Next(iterator)) {
+      auto const count = PyLong_AsSize_t(item);
+      Py_DECREF(item);
+      // Every axis needs an interior point
+      if(PyErr_Occurred() or count < 2) {
+        PyErr_Clear();
+        PyErr_SetString(PyExc_ValueError, "interval counts must be integers of at least 2");
+        break;
+      }
+      counts.push_back(count);
+    }
+    Py_DECREF(iterator);
+    if(PyErr_Occurred()) {
+      return nullptr;
+    }
+
+    params->u0 = wrap_callable(u0);
+    params->k = wrap_callable(k);
+    params->f = wrap_callable(f);
+    auto expected_func = wrap_callable(expected);
+
+    std::vector<ConvergenceRow> rows;
+    bool const done = without_gil([&] {
+      rows = run_box_convergence(params, expected_func, counts);
+    });
+    if(not done) {
+      return nullptr;
+    }
+
+    PyObject* result = PyList_New(0);
+    for(auto const& row : rows) {
+      PyObject* item =
+        Py_BuildValue("(nndd)", row.intervals, row.unknowns, row.inaccuracy, row.seconds);
+      if(item == nullptr or PyList_Append(result, item) != 0) {
+        Py_XDECREF(item);
+        Py_DECREF(result);
+        return nullptr;
+      }
+      Py_DECREF(item);
+    }
+    return result;
+  }
+
+  PyMethodDef methods[] = {
+    {"tridiagonal_solve",
+     tridiagonal_solve,
+     METH_VARARGS,
+     "tridiagonal_solve(a, b, c, rhs): odd-even reduction, rhs is overwritten with the "
+     "solution"},
+    {"stencil",
+     stencil_from_arrays,
+     METH_VARARGS,
+     "stencil((nx, ny, nz), a, b, c, d, e, p, q) -> Stencil, coefficients are copied once"},
+    {"assemble_box",
+     assemble_box,
+     METH_VARARGS,
+     "assemble_box(x_points, y_points, z_points, u0, k, f) -> (Stencil, g)"},
+    {"solve",
+     solve,
+     METH_VARARGS,
+     "solve(stencil, g) -> Vector, nested cyclic reduction or matrix-free CG"},
+    {"run_convergence",
+     run_convergence,
+     METH_VARARGS,
+     "run_convergence((xl, xr, yl, yr, zl, zr), u0, k, f, expected, counts) -> "
+     "[(intervals, unknowns, inaccuracy, seconds)]"},
+    {nullptr}
+  };
+
+  PyModuleDef module = {PyModuleDef_HEAD_INIT, "course", nullptr, -1, methods};
+}
+
+PyMODINIT_FUNC PyInit_course()
+{
+  VectorType.tp_name = "course.Vector";
+  VectorType.tp_basicsize = sizeof(VectorObject);
+  VectorType.tp_flags = Py_TPFLAGS_DEFAULT;
+  VectorType.tp_doc = "float64 vector exported through the buffer protocol";
+  VectorType.tp_dealloc = vector_dealloc;
+  VectorType.tp_as_buffer = &vector_buffer_procs;
+  VectorType.tp_as_sequence = &vector_sequence;
+
+  StencilType.tp_name = "course.Stencil";
+  StencilType.tp_basicsize = sizeof(StencilObject);
+  StencilType.tp_flags = Py_TPFLAGS_DEFAULT;
+  StencilType.tp_doc = "seven-point stencil, coefficients are views into its storage";
+  StencilType.tp_dealloc = stencil_dealloc;
+  StencilType.tp_getset = stencil_getset;
+
+  if(PyType_Ready(&VectorType) < 0 or PyType_Ready(&StencilType) < 0) {
+    return nullptr;
+  }
+
+  PyObject* result = PyModule_Create(&module);
+  if(result == nullptr) {
+    return nullptr;
+  }
+
+  if(PyModule_AddObjectRef(result, "Vector", reinterpret_cast<PyObject*>(&VectorType)) < 0
+     or PyModule_AddObjectRef(result, "Stencil", reinterpret_cast<PyObject*>(&StencilType)) < 0) {
+    Py_DECREF(result);
+    return nullptr;
+  }
+
+  return result;
+}
@@ -0,0 +1,421 @@
+#include <solve_planner.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include <Eigen/SparseLU>
+
+#include <default_impl/block_thomas.hpp>
+#include <default_impl/nested_cyclic_reduction.hpp>
+
+namespace
+{
+  auto is_two_power_minus_one(size_t n) -> bool
+  {
+    return n > 0 and ((n + 1) & n) == 0;
+  }
+
+  // Every axis has more than one unknown, LU fill grows with the cross-section instead of n log n
+  auto is_volume(GridShape const& shape) -> bool
+  {
+    return shape.nx > 1 and shape.ny > 1 and shape.nz > 1;
+  }
+
+  // Unknowns of the smallest cut through the grid, the front COLAMD carries through a volume
+  auto smallest_cross_section(GridShape const& shape) -> double
+  {
+    std::array<size_t, 3> sizes {shape.nx, shape.ny, shape.nz};
+    std::sort(sizes.begin(), sizes.end());
+    return double(sizes[0] * sizes[1]);
+  }
+
+  // Per unknown cost of loading the block rows, in units of block_thomas work
+  constexpr double block_load_units = 400;
+
+  auto main_matrix_nonzeros(GridShape const& shape) -> double
+  {
+    auto const n = double(shape.size());
+    auto const couplings = [&](size_t along) { return along > 0 ? n / along * (along - 1) : 0; };
+    return n + 2 * (couplings(shape.nx) + couplings(shape.ny) + couplings(shape.nz));
+  }
+
+  // Values, inner indices and outer indices of a compressed matrix
+  auto compressed_bytes(double nonzeros, size_t size) -> double
+  {
+    return nonzeros * (sizeof(double) + sizeof(int)) + double(size + 1) * sizeof(int);
+  }
+
+  auto read_status_kilobytes(std::string const& file, std::string const& key) -> size_t
+  {
+    std::ifstream status(file);
+    std::string line;
+    while(std::getline(status, line)) {
+      if(line.starts_with(key)) {
+        std::istringstream values(line.substr(key.size()));
+        size_t kilobytes = 0;
+        values >> kilobytes;
+        return kilobytes * 1024;
+      }
+    }
+    return 0;
+  }
+
+  auto median(std::vector<double> values) -> double
+  {
+    auto const middle = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), middle, values.end());
+    return *middle;
+  }
+}  // namespace
+
+auto solver_name(SolverKind solver) -> std::string
+{
+  switch(solver) {
+    case SolverKind::sparse_lu:
+      return "sparse_lu";
+    case SolverKind::block_thomas:
+      return "block_thomas";
+    case SolverKind::nested_cyclic_reduction:
+      return "nested_cyclic_reduction";
+    case SolverKind::matrix_free_cg:
+      return "matrix_free_cg";
+  }
+  return "unknown";
+}
+
+auto parse_solver(std::string const& name) -> std::optional<SolverKind>
+{
+  for(auto const solver : all_solvers) {
+    if(solver_name(solver) == name) {
+      return solver;
+    }
+  }
+  return std::nullopt;
+}
+
+auto default_cost_model() -> CostModel
+{
+  CostModel model;
+  model[SolverKind::sparse_lu] = {3.5e-8, 1};
+  model[SolverKind::block_thomas] = {4.7e-10, 1.15};
+  model[SolverKind::nested_cyclic_reduction] = {1.1e-8, 1};
+  model[SolverKind::matrix_free_cg] = {8e-8, 1};
+  model.lu_fill = 5.2;
+  model.lu_volume_fill = 0.9;
+  model.lu_volume_work = 0.3;
+  return model;
+}
+
+auto active_cost_model() -> CostModel const&
+{
+  static CostModel const model = calibrate(load_outcomes(default_plan_log_path()), default_cost_model());
+  return model;
+}
+
+auto default_plan_log_path() -> std::filesystem::path
+{
+  if(auto const* path = std::getenv("COURSE_PLAN_LOG")) {
+    return path;
+  }
+  if(auto const* home = std::getenv("HOME")) {
+    return std::filesystem::path(home) / ".cache" / "course" / "plans.txt";
+  }
+  return "course_plans.txt";
+}
+
+auto problem_traits(Stencil7 const& stencil) -> ProblemTraits
+{
+  auto const& shape = stencil.shape;
+  auto const plane = shape.ny * shape.nz;
+  auto same = [](double lhs, double rhs) {
+    return std::abs(lhs - rhs) <= 1e-12 * std::max(std::abs(lhs), std::abs(rhs));
+  };
+
+  bool symmetric = true;
+  bool dominant = true;
+  bool strictly_dominant = false;
+  for(size_t i = 0; i < shape.nx and symmetric and dominant; ++i) {
+    for(size_t j = 0; j < shape.ny; ++j) {
+      for(size_t k = 0; k < shape.nz; ++k) {
+        auto const idx = shape.index({i, j, k});
+
+        // Every coupling towards a larger index against the reverse one of that neighbour
+        symmetric = symmetric and (i + 1 == shape.nx or same(stencil.e(idx), stencil.d(idx + plane)))
+                and (j + 1 == shape.ny or same(stencil.b(idx), stencil.a(idx + shape.nz)))
+                and (k + 1 == shape.nz or same(stencil.q(idx), stencil.p(idx + 1)));
+
+        auto const off_diagonal = std::abs(stencil.a(idx)) + std::abs(stencil.b(idx))
+                                + std::abs(stencil.d(idx)) + std::abs(stencil.e(idx))
+                                + std::abs(stencil.p(idx)) + std::abs(stencil.q(idx));
+        dominant = dominant and stencil.c(idx) > 0 and stencil.c(idx) >= off_diagonal * (1 - 1e-12);
+        strictly_dominant = strictly_dominant or stencil.c(idx) > off_diagonal * (1 + 1e-12);
+      }
+    }
+  }
+
+  return {extract_separable_stencil(stencil).has_value(), symmetric and dominant and strictly_dominant};
+}
+
+auto applicable(SolverKind solver, GridShape const& shape, ProblemTraits const& traits) -> bool
+{
+  switch(solver) {
+    case SolverKind::sparse_lu:
+    case SolverKind::block_thomas:
+      return true;
+    case SolverKind::nested_cyclic_reduction:
+      return traits.separable and is_two_power_minus_one(shape.nx) and is_two_power_minus_one(shape.ny);
+    case SolverKind::matrix_free_cg:
+      return traits.symmetric_positive_definite;
+  }
+  return false;
+}
+
+auto estimate_solve(SolverKind solver, GridShape const& shape, CostModel const& model) -> SolveEstimate
+{
+  auto const n = double(shape.size());
+  auto const vector_bytes = n * sizeof(double);
+  auto const stencil_bytes = 7 * vector_bytes;
+  auto const matrix_bytes = compressed_bytes(main_matrix_nonzeros(shape), shape.size());
+
+  double units = 0;
+  double matrix = 0;
+  double factors = 0;
+  double workspace = 0;
+
+  switch(solver) {
+    case SolverKind::sparse_lu: {
+      // COLAMD on planes: n log n fill and n^1.5 work. On volumes it carries a front of the
+      // smallest cross-section b: n b fill and n b^1.5 work.
+      auto const front = smallest_cross_section(shape);
+      auto const fill =
+        is_volume(shape) ? model.lu_volume_fill * n * front : model.lu_fill * n * std::log2(n + 1);
+      units = is_volume(shape) ? model.lu_volume_work * n * std::pow(front, 1.5) : std::pow(n, 1.5);
+      matrix = matrix_bytes;
+      factors = compressed_bytes(fill, shape.size());
+      // Permuted copy of the matrix, and room the supernodal storage grows into
+      workspace = matrix_bytes + factors / 2;
+      break;
+    }
+    case SolverKind::block_thomas: {
+      auto const block = double(shape.ny * shape.nz);
+      units = shape.nx * block * block * block + block_load_units * n;
+      matrix = matrix_bytes;
+      factors = shape.nx * block * block * sizeof(double);
+      // Row-major copy of the matrix
+      workspace = matrix_bytes;
+      break;
+    }
+    case SolverKind::nested_cyclic_reduction: {
+      units = n * std::log2(shape.nx + 1) * std::log2(shape.ny + 1);
+      matrix = stencil_bytes;
+      // Buneman p blocks of the planes and of one plane
+      workspace = vector_bytes + 2 * double(shape.ny * shape.nz) * sizeof(double);
+      break;
+    }
+    case SolverKind::matrix_free_cg: {
+      // Lines are solved exactly, iterations grow with the larger planar dimension
+      units = n * double(std::max(shape.nx, shape.ny));
+      matrix = stencil_bytes;
+      workspace = 6 * vector_bytes;
+      break;
+    }
+  }
+
+  auto const& cost = model[solver];
+  auto const scaled = [&](double bytes) { return static_cast<size_t>(bytes * cost.memory_scale); };
+  return {
+    solver,
+    {scaled(matrix), scaled(factors), scaled(workspace), scaled(2 * vector_bytes)},
+    units * cost.seconds_per_unit
+  };
+}
+
+auto plan_solve(
+  GridShape const& shape,
+  ProblemTraits const& traits,
+  SolverKind preferred,
+  size_t memory_limit,
+  CostModel const& model
+) -> std::optional<SolvePlan>
+{
+  auto fits = [&](SolveEstimate const& estimate) { return estimate.memory.total() <= memory_limit; };
+
+  auto reason = PlanReason::not_applicable;
+  if(applicable(preferred, shape, traits)) {
+    auto estimate = estimate_solve(preferred, shape, model);
+    if(fits(estimate)) {
+      return SolvePlan {estimate, PlanReason::preferred};
+    }
+    reason = PlanReason::downgraded;
+  }
+
+  std::optional<SolvePlan> best;
+  for(auto const solver : all_solvers) {
+    if(solver == preferred or not applicable(solver, shape, traits)) {
+      continue;
+    }
+    auto estimate = estimate_solve(solver, shape, model);
+    if(fits(estimate) and (not best or estimate.seconds < best->estimate.seconds)) {
+      best = SolvePlan {estimate, reason};
+    }
+  }
+  return best;
+}
+
+auto available_memory() -> size_t
+{
+  auto available = read_status_kilobytes("/proc/meminfo", "MemAvailable:");
+  if(available == 0) {
+    available = std::numeric_limits<size_t>::max();
+  }
+
+  // cgroup v2 limit of this process, "max" when there is none
+  std::ifstream limit_file("/sys/fs/cgroup/memory.max");
+  std::ifstream current_file("/sys/fs/cgroup/memory.current");
+  size_t limit = 0;
+  size_t current = 0;
+  if(limit_file >> limit and current_file >> current) {
+    available = std::min(available, limit > current ? limit - current : 0);
+  }
+  return available;
+}
+
+auto peak_resident_memory() -> size_t
+{
+  return read_status_kilobytes("/proc/self/status", "VmHWM:");
+}
+
+auto resident_memory() -> size_t
+{
+  return read_status_kilobytes("/proc/self/status", "VmRSS:");
+}
+
+void record_outcome(std::filesystem::path const& path, PlanOutcome const& outcome)
+{
+  if(path.has_parent_path()) {
+    std::filesystem::create_directories(path.parent_path());
+  }
+
+  std::ofstream file(path, std::ios::app);
+  file << solver_name(outcome.solver) << ' ' << outcome.shape.nx << ' ' << outcome.shape.ny << ' '
+       << outcome.shape.nz << ' ' << outcome.predicted_bytes << ' ' << outcome.predicted_seconds << ' '
+       << outcome.actual_bytes << ' ' << outcome.actual_seconds << '\n';
+  if(not file) {
+    throw std::runtime_error("can not write " + path.string());
+  }
+}
+
+auto load_outcomes(std::filesystem::path const& path) -> std::vector<PlanOutcome>
+{
+  std::vector<PlanOutcome> outcomes;
+  std::ifstream file(path);
+  std::string line;
+  while(std::getline(file, line)) {
+    std::istringstream values(line);
+    std::string name;
+    PlanOutcome outcome {};
+    if(values >> name >> outcome.shape.nx >> outcome.shape.ny >> outcome.shape.nz >> outcome.predicted_bytes
+       >> outcome.predicted_seconds >> outcome.actual_bytes >> outcome.actual_seconds) {
+      if(auto solver = parse_solver(name)) {
+        outcome.solver = *solver;
+        outcomes.push_back(outcome);
+      }
+    }
+  }
+  return outcomes;
+}
+
+auto calibrate(std::span<PlanOutcome const> outcomes, CostModel model) -> CostModel
+{
+  auto const base = model;
+  for(auto const solver : all_solvers) {
+    std::vector<double> time_ratios;
+    std::vector<double> memory_ratios;
+    for(auto const& outcome : outcomes) {
+      if(outcome.solver != solver) {
+        continue;
+      }
+      // Against `base`, the predictions in the log may come from an older model
+      auto const predicted = estimate_solve(solver, outcome.shape, base);
+      if(predicted.seconds > 0 and outcome.actual_seconds > 0) {
+        time_ratios.push_back(outcome.actual_seconds / predicted.seconds);
+      }
+      if(predicted.memory.total() > 0 and outcome.actual_bytes > 0) {
+        memory_ratios.push_back(double(outcome.actual_bytes) / double(predicted.memory.total()));
+      }
+    }
+
+    if(not time_ratios.empty()) {
+      model[solver].seconds_per_unit *= median(time_ratios);
+    }
+    if(not memory_ratios.empty()) {
+      model[solver].memory_scale *= median(memory_ratios);
+    }
+  }
+  return model;
+}
+
+auto execute_plan(SolvePlan const& plan, IMainMatrixCalculator const& calc) -> PlannedSolution
+{
+  auto const solver = plan.estimate.solver;
+  auto const shape = grid_shape(calc);
+
+  // Restarts VmHWM from the current resident size (Linux 4.0 and later)
+  std::ofstream("/proc/self/clear_refs") << "5";
+  auto const resident_before = resident_memory();
+
+  auto const g = build_g_vector(calc);
+  Eigen::VectorXd w;
+  double seconds = 0;
+  auto timed = [&](auto&& solve) {
+    auto start = std::chrono::steady_clock::now();
+    solve();
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  switch(solver) {
+    case SolverKind::sparse_lu: {
+      auto const matrix = build_main_matrix(calc);
+      timed([&] {
+        Eigen::SparseLU<Eigen::SparseMatrix<double>> lu(matrix);
+        w = lu.solve(g);
+      });
+      break;
+    }
+    case SolverKind::block_thomas: {
+      auto const matrix = build_main_matrix(calc);
+      timed([&] { w = block_thomas_solver(matrix, g, shape.ny * shape.nz); });
+      break;
+    }
+    case SolverKind::nested_cyclic_reduction: {
+      auto const separable = extract_separable_stencil(build_stencil(calc));
+      if(not separable) {
+        throw std::invalid_argument("stencil is not separable");
+      }
+      timed([&] { w = nested_cyclic_reduction_solver(*separable, g); });
+      break;
+    }
+    case SolverKind::matrix_free_cg: {
+      auto const stencil = build_stencil(calc);
+      timed([&] { w = matrix_free_cg_solver(stencil, g); });
+      break;
+    }
+  }
+
+  auto const peak = peak_resident_memory();
+  PlanOutcome outcome {
+    solver,
+    shape,
+    plan.estimate.memory.total(),
+    plan.estimate.seconds,
+    peak > resident_before ? peak - resident_before : 0,
+    seconds
+  };
+  return {std::move(w), outcome};
+}
@@ -0,0 +1,250 @@
+#include <tuning.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <default_impl/odd_even_reduction.hpp>
+
+namespace
+{
+  auto tuning_storage() -> SolverTuning&
+  {
+    static SolverTuning tuning =
+      load_tuning(default_tuning_path(), cpu_model()).value_or(SolverTuning {});
+    return tuning;
+  }
+
+  // Restores the active tuning when the sweep is over
+  class TuningGuard
+  {
+   public:
+    TuningGuard()
+      : m_saved(active_tuning())
+    {}
+
+    ~TuningGuard() { set_active_tuning(m_saved); }
+
+   private:
+    SolverTuning m_saved;
+  };
+
+  // Best of a few runs, every run repeats `kernel` until it takes a measurable time
+  template<typename Kernel>
+  auto measure(Kernel&& kernel) -> double
+  {
+    using Clock = std::chrono::steady_clock;
+    static constexpr auto min_run = std::chrono::milliseconds(5);
+    static constexpr int runs = 3;
+
+    double best = std::numeric_limits<double>::max();
+    for(int run = 0; run < runs; ++run) {
+      size_t repeats = 0;
+      auto const start = Clock::now();
+      auto elapsed = Clock::duration::zero();
+      while(elapsed < min_run) {
+        kernel();
+        ++repeats;
+        elapsed = Clock::now() - start;
+      }
+      best = std::min(best, std::chrono::duration<double>(elapsed).count() / repeats);
+    }
+    return best;
+  }
+
+  // Diagonally dominant, like the line operators of the schemes
+  struct TestSystem
+  {
+    explicit TestSystem(size_t n)
+      : a(Eigen::VectorXd::Constant(n, -1))
+      , b(Eigen::VectorXd::Constant(n, 4) + Eigen::VectorXd::Random(n))
+      , c(Eigen::VectorXd::Constant(n, -1))
+      , rhs(Eigen::VectorXd::Random(n))
+      , w(n)
+      , workspace(odd_even_reduction_workspace_size(n))
+    {}
+
+    void solve()
+    {
+      w = rhs;
+      odd_even_reduction_solve(a, b, c, w, workspace);
+    }
+
+    Eigen::VectorXd a, b, c, rhs, w, workspace;
+  };
+}
+
+auto default_assembly_threads() -> size_t
+{
+  return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+auto active_tuning() -> SolverTuning const&
+{
+  return tuning_storage();
+}
+
+void set_active_tuning(SolverTuning tuning)
+{
+  tuning_storage() = tuning;
+}
+
+auto cpu_model() -> std::string
+{
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while(std::getline(cpuinfo, line)) {
+    if(line.starts_with("model name")) {
+      auto const colon = line.find(':');
+      if(colon != std::string::npos) {
+        auto model = line.substr(line.find_first_not_of(' ', colon + 1));
+        // Tabs separate the key in the tuning file
+        std::replace(model.begin(), model.end(), '\t', ' ');
+        return model;
+      }
+    }
+  }
+  return "unknown";
+}
+
+auto default_tuning_path() -> std::filesystem::path
+{
+  if(auto const* path = std::getenv("COURSE_TUNING_FILE")) {
+    return path;
+  }
+  if(auto const* home = std::getenv("HOME")) {
+    return std::filesystem::path(home) / ".cache" / "course" / "tuning.txt";
+  }
+  return "course_tuning.txt";
+}
+
+auto load_tuning(std::filesystem::path const& path, std::string const& cpu)
+  -> std::optional<SolverTuning>
+{
+  std::ifstream file(path);
+  std::string line;
+  while(std::getline(file, line)) {
+    auto const tab = line.find('\t');
+    if(tab == std::string::npos or line.substr(0, tab) != cpu) {
+      continue;
+    }
+
+    SolverTuning tuning;
+    std::istringstream values(line.substr(tab + 1));
+    if(values >> tuning.thomas_cutoff >> tuning.line_batch >> tuning.threads) {
+      tuning.thomas_cutoff = std::max<size_t>(tuning.thomas_cutoff, 1);
+      tuning.line_batch = std::max<size_t>(tuning.line_batch, 1);
+      tuning.threads = std::max<size_t>(tuning.threads, 1);
+      return tuning;
+    }
+  }
+  return std::nullopt;
+}
+
+void save_tuning(
+  std::filesystem::path const& path,
+  std::string const& cpu,
+  SolverTuning const& tuning
+)
+{
+  std::map<std::string, std::string> entries;
+  {
+    std::ifstream file(path);
+    std::string line;
+    while(std::getline(file, line)) {
+      auto const tab = line.find('\t');
+      if(tab != std::string::npos) {
+        entries[line.substr(0, tab)] = line.substr(tab + 1);
+      }
+    }
+  }
+
+  std::ostringstream values;
+  values << tuning.thomas_cutoff << ' ' << tuning.line_batch << ' ' << tuning.threads;
+  entries[cpu] = values.str();
+
+  if(path.has_parent_path()) {
+    std::filesystem::create_directories(path.parent_path());
+  }
+
+  // Written aside and renamed, so a reader never sees a partial file
+  auto temporary = path;
+  temporary += ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::trunc);
+    for(auto const& [model, entry] : entries) {
+      file << model << '\t' << entry << '\n';
+    }
+    if(not file) {
+      throw std::runtime_error("can not write " + temporary.string());
+    }
+  }
+  std::filesystem::rename(temporary, path);
+}
+
+auto autotune(std::span<size_t const> sizes) -> SolverTuning
+{
+  TuningGuard guard;
+  SolverTuning best = active_tuning();
+
+  // Cutoff: summed time over the representative sizes, each normalized by plain reduction
+  static constexpr size_t cutoffs[] = {1, 4, 8, 16, 32, 64, 128, 256};
+  double best_score = std::numeric_limits<double>::max();
+  for(auto const cutoff : cutoffs) {
+    double score = 0;
+    for(auto const n : sizes) {
+      TestSystem system(n);
+
+      set_active_tuning({1, best.line_batch, 1});
+      auto const reference = measure([&] { system.solve(); });
+
+      set_active_tuning({cutoff, best.line_batch, 1});
+      score += measure([&] { system.solve(); }) / reference;
+    }
+    if(score < best_score) {
+      best_score = score;
+      best.thomas_cutoff = cutoff;
+    }
+  }
+
+  // Threads and batch: independent lines of the largest representative length
+  auto const length = sizes.empty() ? size_t(64) : *std::max_element(sizes.begin(), sizes.end());
+  auto const lines = std::max<size_t>((size_t(1) << 20) / std::max<size_t>(length, 1), 64);
+  TestSystem system(length * lines);
+  Eigen::VectorXd w(system.rhs.size());
+
+  static constexpr size_t batches[] = {1, 4, 16, 64, 256};
+  auto const hardware = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  double best_time = std::numeric_limits<double>::max();
+  std::vector<size_t> thread_counts;
+  for(size_t threads = 1; threads < hardware; threads *= 2) {
+    thread_counts.push_back(threads);
+  }
+  thread_counts.push_back(hardware);
+
+  for(auto const threads : thread_counts) {
+    for(auto const batch : batches) {
+      set_active_tuning({best.thomas_cutoff, batch, threads});
+      auto const time = measure([&] {
+        w = system.rhs;
+        odd_even_reduction_solve_lines(system.a, system.b, system.c, w, length);
+      });
+      if(time < best_time) {
+        best_time = time;
+        best.line_batch = batch;
+        best.threads = threads;
+      }
+    }
+  }
+
+  return best;
+}
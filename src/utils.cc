@@ -2,10 +2,20 @@
 #include <iomanip>
 #include <thread>
 #include <random>
+#include <chrono>
+#include <new>
+#include <optional>
+
+#include <Eigen/SparseCholesky>
+#include <Eigen/SparseLU>
 
 #include <utils.hpp>
 #include <default_impl/main_matrix_calculator.hpp>
+#include <default_impl/main_matrix_calculator_3d.hpp>
+#include <default_impl/nested_cyclic_reduction.hpp>
 #include <interval_splitter.hpp>
+#include <matrix_builder.hpp>
+#include <grid_ordering.hpp>
 
 /*
 2,22E-16
@@ -204,3 +214,152 @@ void do_all1(std::shared_ptr<InputParameters> params, X_Y_Function_type expected
     }
   }
 }
+
+auto run_box_convergence(
+  std::shared_ptr<InputParameters3D> params,
+  X_Y_Z_Function_type expected_func,
+  std::span<size_t const> interval_counts
+) -> std::vector<ConvergenceRow>
+{
+  std::vector<ConvergenceRow> rows;
+
+  for(auto const count : interval_counts) {
+    DefaultMainMatrixCalculator3D calc(
+      params,
+      split_interval(params->xl, params->xr, count),
+      split_interval(params->yl, params->yr, count),
+      split_interval(params->zl, params->zr, count)
+    );
+
+    auto stencil = build_stencil(calc);
+    auto g_vector = build_g_vector(calc);
+
+    auto start = std::chrono::steady_clock::now();
+    Eigen::VectorXd solution = seven_point_solver(stencil, g_vector);
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    auto const shape = stencil.shape;
+    double inaccuracy = 0;
+    for(size_t i = 0; i < shape.nx; ++i) {
+      for(size_t j = 0; j < shape.ny; ++j) {
+        for(size_t k = 0; k < shape.nz; ++k) {
+          auto expected = expected_func(
+            calc.interiour_x_points()[i], calc.interiour_y_points()[j], calc.interiour_z_points()[k]
+          );
+          inaccuracy = std::max(inaccuracy, std::abs(solution(shape.index({i, j, k})) - expected));
+        }
+      }
+    }
+
+    rows.push_back({count, shape.size(), inaccuracy, elapsed.count()});
+  }
+
+  return rows;
+}
+
+namespace
+{
+  template<typename Solver>
+  auto time_factorization(Eigen::SparseMatrix<double> const& matrix, Solver& solver) -> double
+  {
+    auto start = std::chrono::steady_clock::now();
+    solver.analyzePattern(matrix);
+    solver.factorize(matrix);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  // SparseLU reports a failed allocation through info() instead of throwing
+  template<typename Ordering>
+  auto factorize_lu(Eigen::SparseMatrix<double> const& matrix) -> std::optional<std::pair<size_t, double>>
+  {
+    Eigen::SparseLU<Eigen::SparseMatrix<double>, Ordering> solver;
+    auto const seconds = time_factorization(matrix, solver);
+    if(solver.info() != Eigen::Success) {
+      return std::nullopt;
+    }
+    return std::pair<size_t, double>{solver.nnzL() + solver.nnzU(), seconds};
+  }
+
+  template<typename Ordering>
+  auto factorize_ldlt(Eigen::SparseMatrix<double> const& matrix) -> std::optional<std::pair<size_t, double>>
+  {
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>, Eigen::Lower, Ordering> solver;
+    auto const seconds = time_factorization(matrix, solver);
+    if(solver.info() != Eigen::Success) {
+      return std::nullopt;
+    }
+    auto const nonzeros = static_cast<size_t>(solver.matrixL().nestedExpression().nonZeros());
+    return std::pair<size_t, double>{nonzeros, seconds};
+  }
+}
+
+auto compare_orderings(std::span<size_t const> interval_counts) -> std::vector<OrderingComparisonRow>
+{
+  using StorageIndex = Eigen::SparseMatrix<double>::StorageIndex;
+
+  // Dense blocks between lines beyond this many values are not attempted
+  static constexpr size_t cyclic_reduction_fill_limit = size_t(1) << 26;
+
+  auto params = std::make_shared<InputParameters3D>();
+  params->xl = 0;
+  params->xr = 1;
+  params->yl = 0;
+  params->yr = 1;
+  params->zl = 0;
+  params->zr = 1;
+  params->u0 = [](double, double, double) { return 0; };
+  params->k = [](double, double, double) { return 1; };
+  params->f = [](double, double, double) { return 1; };
+
+  std::vector<OrderingComparisonRow> rows;
+  for(auto const count : interval_counts) {
+    // A single interior z layer leaves the planar five-point operator
+    DefaultMainMatrixCalculator3D calc(
+      params,
+      split_interval(params->xl, params->xr, count),
+      split_interval(params->yl, params->yr, count),
+      split_interval(params->zl, params->zr, 2)
+    );
+    auto const matrix = build_main_matrix(calc);
+    auto const lines = count - 1;
+    bool const cyclic_reduction_fits = lines * lines * lines <= cyclic_reduction_fill_limit;
+
+    // A factorization that does not fit is recorded, the remaining ones still run
+    auto add = [&](char const* factorization, char const* ordering, auto factorize) {
+      std::optional<std::pair<size_t, double>> result;
+      try {
+        result = factorize(matrix);
+      }
+      catch(std::bad_alloc const&) {
+      }
+      if(result) {
+        rows.push_back({count, factorization, ordering, result->first, result->second});
+      }
+      else {
+        rows.push_back({count, factorization, ordering, 0, 0, false});
+      }
+    };
+
+    add("SparseLU", "COLAMD", factorize_lu<Eigen::COLAMDOrdering<StorageIndex>>);
+    add("SparseLU", "nested dissection", factorize_lu<NestedDissectionLUOrdering<StorageIndex>>);
+    if(cyclic_reduction_fits) {
+      add("SparseLU", "cyclic reduction", factorize_lu<CyclicReductionLUOrdering<StorageIndex>>);
+    }
+
+    add("SimplicialLDLT", "AMD", factorize_ldlt<Eigen::AMDOrdering<StorageIndex>>);
+    add(
+      "SimplicialLDLT",
+      "nested dissection",
+      factorize_ldlt<NestedDissectionCholeskyOrdering<StorageIndex>>
+    );
+    if(cyclic_reduction_fits) {
+      add(
+        "SimplicialLDLT",
+        "cyclic reduction",
+        factorize_ldlt<CyclicReductionCholeskyOrdering<StorageIndex>>
+      );
+    }
+  }
+
+  return rows;
+}
@@ -0,0 +1,113 @@
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+#include <batch_evaluation.hpp>
+#include <default_impl/main_matrix_calculator.hpp>
+#include <interval_splitter.hpp>
+#include <matrix_builder.hpp>
+#include <padded_grid.hpp>
+
+#include "test_utils.hpp"
+
+namespace
+{
+  auto plate() -> std::shared_ptr<InputParameters>
+  {
+    auto params = std::make_shared<InputParameters>();
+    params->xl = 1;
+    params->xr = 2;
+    params->yl = 0;
+    params->yr = 3;
+    params->u1 = [](double y) { return std::sin(y); };
+    params->u3 = [](double x) { return x * x; };
+    params->u4 = [](double x) { return std::exp(x); };
+    params->k1 = [](double x) { return 1 + x; };
+    params->hi2 = 4;
+    params->u2 = [](double y) { return y * y; };
+    params->f = [](double x, double y) { return x * std::cos(y); };
+    return params;
+  }
+
+  // Counts the calls of a batch form built from the scalar function. Assembly calls it from
+  // several threads, so the count is atomic.
+  template<typename Scalar>
+  auto counted(Scalar scalar, std::atomic<size_t>& calls)
+  {
+    return [batch = batched(std::move(scalar)), &calls](auto... args) {
+      ++calls;
+      batch(args...);
+    };
+  }
+
+  void check_evaluate()
+  {
+    std::vector<double> const x {0, 0.5, 1, 2};
+    std::vector<double> const y {1, 2, 3, 4};
+    std::vector<double> out(x.size());
+
+    size_t scalar_calls = 0;
+    X_Function_type const scalar = [&](double value) {
+      ++scalar_calls;
+      return 2 * value;
+    };
+    evaluate({}, scalar, x, out);
+    check(scalar_calls == x.size() and out[3] == 4, "without a batch the scalar runs per point");
+
+    Batch_X_Function_type const batch = [](std::span<double const> points, std::span<double> values) {
+      for(size_t n = 0; n < points.size(); ++n) {
+        values[n] = 3 * points[n];
+      }
+    };
+    scalar_calls = 0;
+    evaluate(batch, scalar, x, out);
+    check(scalar_calls == 0 and out[3] == 6, "a set batch replaces the scalar");
+
+    evaluate({}, X_Y_Function_type([](double a, double b) { return a * b; }), x, y, out);
+    check(out[1] == 1 and out[3] == 8, "two-argument scalar per point");
+  }
+
+  // Batch forms of the same functions assemble the same system
+  void check_assembly(size_t x_count, size_t y_count)
+  {
+    auto const scalar_params = plate();
+    auto const batch_params = plate();
+    std::atomic<size_t> calls = 0;
+    batch_params->u1_batch = counted(batch_params->u1, calls);
+    batch_params->u2_batch = counted(batch_params->u2, calls);
+    batch_params->u3_batch = counted(batch_params->u3, calls);
+    batch_params->u4_batch = counted(batch_params->u4, calls);
+    batch_params->f_batch = counted(batch_params->f, calls);
+
+    auto const x_points = split_interval(scalar_params->xl, scalar_params->xr, x_count);
+    auto const y_points = split_interval(scalar_params->yl, scalar_params->yr, y_count);
+    DefaultMainMatrixCalculator scalar_calc(scalar_params, x_points, y_points);
+    DefaultMainMatrixCalculator batch_calc(batch_params, x_points, y_points);
+
+    auto const matrix = build_main_matrix(scalar_calc);
+    auto const g = build_g_vector(scalar_calc);
+    auto const batch_g = build_g_vector(batch_calc);
+    check(calls > 0, "assembly calls the batch forms");
+    check(relative_difference(batch_g, g) < 1e-14, "batch g matches scalar g");
+    auto const batch_solution = sparse_lu_solution(build_main_matrix(batch_calc), batch_g);
+    check(
+      relative_difference(batch_solution, sparse_lu_solution(matrix, g)) < 1e-12,
+      "batch system solves like the scalar one"
+    );
+
+    calls = 0;
+    auto const samples = sample_boundary(batch_calc);
+    auto const expected = sample_boundary(scalar_calc);
+    check(calls == 4, "every boundary edge is sampled in one call");
+    check(samples.u1 == expected.u1 and samples.u4 == expected.u4, "batch samples match scalar samples");
+  }
+}  // namespace
+
+int main()
+{
+  check_evaluate();
+  check_assembly(5, 7);
+  check_assembly(16, 3);
+
+  return failed_checks();
+}
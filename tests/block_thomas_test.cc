@@ -0,0 +1,106 @@
+#include <stdexcept>
+
+#include <default_impl/block_thomas.hpp>
+#include <default_impl/main_matrix_calculator.hpp>
+#include <default_impl/main_matrix_calculator_3d.hpp>
+#include <interval_splitter.hpp>
+#include <matrix_builder.hpp>
+
+#include "test_utils.hpp"
+
+namespace
+{
+  // Blocks of ny * nz unknowns, fixed-size kernels up to max_fixed_block_size, dynamic above
+  void check_box(size_t nx, size_t ny, size_t nz)
+  {
+    auto const params = unit_box([](double x, double y, double z) { return 1 + x * y + z; });
+    DefaultMainMatrixCalculator3D calc(
+      params,
+      split_interval(params->xl, params->xr, nx + 1),
+      split_interval(params->yl, params->yr, ny + 1),
+      split_interval(params->zl, params->zr, nz + 1)
+    );
+    auto const matrix = build_main_matrix(calc);
+    auto const g = build_g_vector(calc);
+    auto const expected = sparse_lu_solution(matrix, g);
+
+    auto const block_size = ny * nz;
+    auto const w = block_thomas_solver(matrix, g, block_size);
+    check(relative_difference(w, expected) < 1e-12, "box matches SparseLU");
+
+    Eigen::VectorXd in_place = g;
+    block_thomas_solve(matrix, in_place, block_size);
+    check(relative_difference(in_place, expected) < 1e-12, "in place solve matches SparseLU");
+  }
+
+  // Planar scheme with its first and third type rows, blocks of ny unknowns
+  void check_plate(size_t x_count, size_t y_count)
+  {
+    auto params = std::make_shared<InputParameters>();
+    params->xl = 0;
+    params->xr = 4;
+    params->yl = 0;
+    params->yr = 1;
+    params->u1 = [](double y) { return y; };
+    params->u3 = [](double x) { return x; };
+    params->u4 = [](double x) { return x + 1; };
+    params->k1 = [](double) { return 3; };
+    params->hi2 = 2;
+    params->u2 = [](double y) { return 4 + y; };
+    params->f = [](double x, double y) { return x * y; };
+
+    DefaultMainMatrixCalculator calc(
+      params,
+      split_interval(params->xl, params->xr, x_count),
+      split_interval(params->yl, params->yr, y_count)
+    );
+    auto const matrix = build_main_matrix(calc);
+    auto const g = build_g_vector(calc);
+    auto const ny = calc.interiour_y_points().size();
+
+    check(
+      relative_difference(block_thomas_solver(matrix, g, ny), sparse_lu_solution(matrix, g)) < 1e-12,
+      "plate matches SparseLU"
+    );
+  }
+
+  void check_rejects_wider_coupling()
+  {
+    auto const params = unit_box();
+    DefaultMainMatrixCalculator3D calc(
+      params,
+      split_interval(params->xl, params->xr, 5),
+      split_interval(params->yl, params->yr, 3),
+      split_interval(params->zl, params->zr, 3)
+    );
+    auto matrix = build_main_matrix(calc);
+    auto const g = build_g_vector(calc);
+
+    // Couples the first plane to the third one
+    matrix.coeffRef(0, 8) = 1;
+    bool thrown = false;
+    try {
+      block_thomas_solver(matrix, g, 4);
+    }
+    catch(std::invalid_argument const&) {
+      thrown = true;
+    }
+    check(thrown, "coupling beyond the neighbouring block throws");
+  }
+}  // namespace
+
+int main()
+{
+  check_box(40, 1, 1);
+  check_box(30, 2, 3);
+  check_box(12, 4, 4);
+  check_box(6, 5, 4);
+  check_box(3, 7, 7);
+
+  check_plate(60, 4);
+  check_plate(9, 12);
+
+  check_rejects_wider_coupling();
+
+  return failed_checks();
+}
@@ -0,0 +1,99 @@
+#include <stdexcept>
+
+#include <boundary_condensation.hpp>
+#include <default_impl/main_matrix_calculator.hpp>
+#include <interval_splitter.hpp>
+#include <matrix_builder.hpp>
+#include <padded_grid.hpp>
+
+#include "test_utils.hpp"
+
+namespace
+{
+  auto plate() -> std::shared_ptr<InputParameters>
+  {
+    auto params = std::make_shared<InputParameters>();
+    params->xl = 1;
+    params->xr = 3;
+    params->yl = 0;
+    params->yr = 2;
+    params->u1 = [](double y) { return 1 + y * y; };
+    params->u3 = [](double x) { return x * x; };
+    params->u4 = [](double x) { return x * x + 4; };
+    params->k1 = [](double) { return 2; };
+    params->hi2 = 5;
+    params->u2 = [](double y) { return 9 + y * y; };
+    params->f = [](double x, double y) { return x + y; };
+    return params;
+  }
+
+  // The condensed solve scattered into the padded grid equals the solve of the full system
+  void check_condensed_solve(size_t x_count, size_t y_count)
+  {
+    auto const params = plate();
+    DefaultMainMatrixCalculator calc(
+      params,
+      split_interval(params->xl, params->xr, x_count),
+      split_interval(params->yl, params->yr, y_count)
+    );
+    auto const matrix = build_main_matrix(calc);
+    auto const g = build_g_vector(calc);
+    auto const expected = sparse_lu_solution(matrix, g);
+
+    auto condensed = condense_boundary(calc, matrix, g);
+    auto const unknowns = condensed.kept.size() + condensed.eliminated.size();
+    check(unknowns == static_cast<size_t>(expected.size()), "every unknown is kept or eliminated");
+
+    PaddedGrid grid(calc.interiour_x_points().size(), calc.interiour_y_points().size());
+    Eigen::SparseLU<Eigen::SparseMatrix<double>> solver;
+    solver.compute(condensed.matrix);
+    solve_into(solver, condensed, grid);
+
+    Eigen::VectorXd actual(expected.size());
+    for(size_t i = 0; i < grid.nx(); ++i) {
+      actual.segment(static_cast<Eigen::Index>(i * grid.ny()), static_cast<Eigen::Index>(grid.ny())) =
+        grid.interior_row(i);
+    }
+    check(relative_difference(actual, expected) < 1e-12, "condensed solve matches the full system");
+  }
+
+  // An eliminated row with an off-diagonal entry is not an identity row and is rejected,
+  // whether the entry lies in an eliminated or a kept column
+  void check_rejects_coupled_rows()
+  {
+    auto const params = plate();
+    DefaultMainMatrixCalculator calc(
+      params,
+      split_interval(params->xl, params->xr, 5),
+      split_interval(params->yl, params->yr, 5)
+    );
+    auto const g = build_g_vector(calc);
+    auto const ny = static_cast<Eigen::Index>(calc.interiour_y_points().size());
+
+    for(auto const column : {Eigen::Index(1), ny + 1}) {
+      auto matrix = build_main_matrix(calc);
+      matrix.coeffRef(0, column) += 1;
+
+      bool thrown = false;
+      try {
+        condense_boundary(calc, matrix, g);
+      }
+      catch(std::invalid_argument const&) {
+        thrown = true;
+      }
+      check(thrown, "off-diagonal entry in a first type row throws");
+    }
+  }
+}  // namespace
+
+int main()
+{
+  check_condensed_solve(4, 4);
+  check_condensed_solve(7, 3);
+  check_condensed_solve(3, 9);
+  check_condensed_solve(16, 16);
+
+  check_rejects_coupled_rows();
+
+  return failed_checks();
+}
@@ -0,0 +1,91 @@
+#include <filesystem>
+#include <random>
+#include <string>
+
+#include <default_impl/main_matrix_calculator_3d.hpp>
+#include <factorization_store.hpp>
+#include <interval_splitter.hpp>
+#include <matrix_builder.hpp>
+
+#include "test_utils.hpp"
+
+namespace
+{
+  auto box_system(size_t count) -> std::pair<Eigen::SparseMatrix<double>, Eigen::VectorXd>
+  {
+    auto const params = unit_box([](double x, double y, double z) { return 1 + x + y * z; });
+    DefaultMainMatrixCalculator3D calc(
+      params,
+      split_interval(params->xl, params->xr, count),
+      split_interval(params->yl, params->yr, count + 1),
+      split_interval(params->zl, params->zr, count + 2)
+    );
+    return {build_main_matrix(calc), build_g_vector(calc)};
+  }
+
+  // Saved factors solve like the solver they came from, under their key only
+  void check_round_trip(std::filesystem::path const& directory)
+  {
+    auto const [matrix, g] = box_system(6);
+    auto const expected = sparse_lu_solution(matrix, g);
+
+    Eigen::SparseLU<Eigen::SparseMatrix<double>> solver;
+    solver.compute(matrix);
+    auto const key = factorization_key(matrix);
+    auto const path = factorization_path(directory, key);
+    save_factorization(path, key, extract_lu_factors(solver));
+
+    auto const stored = StoredFactorization::open(path, key);
+    check(stored.has_value(), "saved factors open under their key");
+    if(stored) {
+      check(stored->rows() == matrix.rows(), "stored size");
+      check(relative_difference(stored->solve(g), expected) < 1e-12, "stored factors match SparseLU");
+
+      Eigen::VectorXd in_place = g;
+      Eigen::VectorXd workspace(stored->rows());
+      stored->solve_in_place(in_place, workspace);
+      check(relative_difference(in_place, expected) < 1e-12, "in place solve matches SparseLU");
+    }
+
+    check(not StoredFactorization::open(path, key + 1), "another key is rejected");
+    check(not StoredFactorization::open(directory / "missing.lu", key), "a missing file is rejected");
+
+    auto const [other_matrix, other_g] = box_system(5);
+    check(factorization_key(other_matrix) != key, "another grid gives another key");
+
+    auto const truncated = directory / "truncated.lu";
+    std::filesystem::copy_file(path, truncated);
+    std::filesystem::resize_file(truncated, std::filesystem::file_size(path) / 2);
+    check(not StoredFactorization::open(truncated, key), "a truncated file is rejected");
+  }
+
+  // The first call factorizes and stores, the second maps the same file
+  void check_load_or_factorize(std::filesystem::path const& directory)
+  {
+    auto const [matrix, g] = box_system(4);
+    auto const expected = sparse_lu_solution(matrix, g);
+    auto const path = factorization_path(directory, factorization_key(matrix));
+
+    auto const first = load_or_factorize(matrix, directory);
+    check(std::filesystem::exists(path), "factors are stored on first use");
+    auto const written = std::filesystem::last_write_time(path);
+
+    auto const second = load_or_factorize(matrix, directory);
+    check(std::filesystem::last_write_time(path) == written, "stored factors are reused");
+    check(relative_difference(first.solve(g), expected) < 1e-12, "fresh factors match SparseLU");
+    check(relative_difference(second.solve(g), expected) < 1e-12, "reused factors match SparseLU");
+  }
+}  // namespace
+
+int main()
+{
+  auto const directory = std::filesystem::temp_directory_path()
+                         / ("course-factorization-store-test-" + std::to_string(std::random_device()()));
+  std::filesystem::create_directories(directory);
+
+  check_round_trip(directory);
+  check_load_or_factorize(directory);
+
+  std::filesystem::remove_all(directory);
+  return failed_checks();
+}
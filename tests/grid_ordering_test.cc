@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <numeric>
+
+#include <Eigen/SparseCholesky>
+
+#include <boundary_condensation.hpp>
+#include <default_impl/main_matrix_calculator.hpp>
+#include <default_impl/main_matrix_calculator_3d.hpp>
+#include <grid_ordering.hpp>
+#include <interval_splitter.hpp>
+#include <matrix_builder.hpp>
+
+#include "test_utils.hpp"
+
+namespace
+{
+  using StorageIndex = Eigen::SparseMatrix<double>::StorageIndex;
+
+  auto is_permutation_of_unknowns(std::vector<size_t> order, size_t size) -> bool
+  {
+    std::vector<size_t> unknowns(size);
+    std::iota(unknowns.begin(), unknowns.end(), size_t(0));
+    std::ranges::sort(order);
+    return order == unknowns;
+  }
+
+  template<typename Ordering>
+  auto lu_solution(Eigen::SparseMatrix<double> const& matrix, Eigen::VectorXd const& g) -> Eigen::VectorXd
+  {
+    Eigen::SparseLU<Eigen::SparseMatrix<double>, Ordering> solver;
+    solver.compute(matrix);
+    return solver.solve(g);
+  }
+
+  template<typename Ordering>
+  auto ldlt_solution(Eigen::SparseMatrix<double> const& matrix, Eigen::VectorXd const& g) -> Eigen::VectorXd
+  {
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>, Eigen::Lower, Ordering> solver;
+    solver.compute(matrix);
+    return solver.solve(g);
+  }
+
+  // Both orderings under both factorizations solve the planar five-point system like SparseLU
+  void check_planar_grid(size_t x_count, size_t y_count)
+  {
+    auto const params = unit_box();
+    DefaultMainMatrixCalculator3D calc(
+      params,
+      split_interval(params->xl, params->xr, x_count),
+      split_interval(params->yl, params->yr, y_count),
+      split_interval(params->zl, params->zr, 2)
+    );
+    auto const matrix = build_main_matrix(calc);
+    auto const g = build_g_vector(calc);
+    auto const expected = sparse_lu_solution(matrix, g);
+
+    auto const nx = x_count - 1;
+    auto const ny = y_count - 1;
+    check(is_permutation_of_unknowns(cyclic_reduction_order(nx, ny), nx * ny), "cyclic reduction order");
+    check(is_permutation_of_unknowns(nested_dissection_order(nx, ny), nx * ny), "nested dissection order");
+    check(is_grid_pattern(matrix, deduce_grid_columns(matrix)), "five-point matrix has the grid pattern");
+    check(nx == 1 or deduce_grid_columns(matrix) == ny, "ny is deduced from the pattern");
+
+    check(
+      relative_difference(lu_solution<CyclicReductionLUOrdering<StorageIndex>>(matrix, g), expected) < 1e-10,
+      "LU under cyclic reduction ordering"
+    );
+    check(
+      relative_difference(lu_solution<NestedDissectionLUOrdering<StorageIndex>>(matrix, g), expected) < 1e-10,
+      "LU under nested dissection ordering"
+    );
+    check(
+      relative_difference(ldlt_solution<CyclicReductionCholeskyOrdering<StorageIndex>>(matrix, g), expected)
+        < 1e-10,
+      "LDLT under cyclic reduction ordering"
+    );
+    check(
+      relative_difference(ldlt_solution<NestedDissectionCholeskyOrdering<StorageIndex>>(matrix, g), expected)
+        < 1e-10,
+      "LDLT under nested dissection ordering"
+    );
+  }
+
+  // A condensed matrix is numbered past the eliminated unknowns, the orderings fall back
+  void check_condensed_matrix()
+  {
+    auto params = std::make_shared<InputParameters>();
+    params->xl = 0;
+    params->xr = 1;
+    params->yl = 0;
+    params->yr = 1;
+    params->u1 = [](double y) { return y; };
+    params->u3 = [](double x) { return x; };
+    params->u4 = [](double x) { return x + 1; };
+    params->k1 = [](double) { return 1; };
+    params->hi2 = 2;
+    params->u2 = [](double y) { return y + 1; };
+    params->f = [](double, double) { return 1; };
+
+    DefaultMainMatrixCalculator calc(params, split_interval(0, 1, 9), split_interval(0, 1, 7));
+    auto const condensed = condense_boundary(calc, build_main_matrix(calc), build_g_vector(calc));
+    auto const& matrix = condensed.matrix;
+    auto const& g = condensed.g;
+    auto const expected = sparse_lu_solution(matrix, g);
+
+    check(
+      relative_difference(lu_solution<NestedDissectionLUOrdering<StorageIndex>>(matrix, g), expected) < 1e-10,
+      "condensed matrix under nested dissection ordering"
+    );
+    check(
+      relative_difference(lu_solution<CyclicReductionLUOrdering<StorageIndex>>(matrix, g), expected) < 1e-10,
+      "condensed matrix under cyclic reduction ordering"
+    );
+  }
+
+  void check_rejects_other_patterns()
+  {
+    // Coupling between unknowns 2 and 5 fits no line length
+    Eigen::SparseMatrix<double> matrix(6, 6);
+    for(Eigen::Index i = 0; i < 6; ++i) {
+      matrix.insert(i, i) = 4;
+    }
+    matrix.insert(2, 5) = 1;
+    matrix.insert(5, 2) = 1;
+    check(not is_grid_pattern(matrix, 1) and not is_grid_pattern(matrix, 2), "no line length fits");
+    check(not is_grid_pattern(matrix, 4), "size must be whole lines");
+  }
+}  // namespace
+
+int main()
+{
+  check_planar_grid(10, 14);
+  check_planar_grid(2, 41);
+  check_planar_grid(41, 2);
+  check_planar_grid(34, 34);
+
+  check_condensed_matrix();
+  check_rejects_other_patterns();
+
+  return failed_checks();
+}
@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+#include <default_impl/main_matrix_calculator_3d.hpp>
+#include <default_impl/nested_cyclic_reduction.hpp>
+#include <interval_splitter.hpp>
+#include <matrix_builder.hpp>
+
+#include "test_utils.hpp"
+
+namespace
+{
+  auto is_split_of(std::vector<double> const& points, double left, double right, size_t intervals) -> bool
+  {
+    return points.size() == intervals + 1 and points.front() == left and points.back() == right
+           and std::ranges::adjacent_find(points, std::greater_equal<>()) == points.end();
+  }
+
+  auto lengths(std::vector<double> const& points) -> std::vector<double>
+  {
+    std::vector<double> result(points.size() - 1);
+    for(size_t m = 0; m + 1 < points.size(); ++m) {
+      result[m] = points[m + 1] - points[m];
+    }
+    return result;
+  }
+
+  void check_graded_splits()
+  {
+    for(auto const end : {GradedEnd::left, GradedEnd::right, GradedEnd::both}) {
+      auto const geometric = split_interval_geometric(-1, 2, 12, 1.2, end);
+      auto const tanh = split_interval_tanh(-1, 2, 12, 2, end);
+      check(is_split_of(geometric, -1, 2, 12), "geometric split covers the interval in order");
+      check(is_split_of(tanh, -1, 2, 12), "tanh split covers the interval in order");
+    }
+    check(is_split_of(split_interval_chebyshev(-1, 2, 12), -1, 2, 12), "Chebyshev split covers the interval");
+
+    // Every interval is `ratio` times its neighbour towards the refined end
+    auto const right = lengths(split_interval_geometric(0, 1, 8, 1.5, GradedEnd::right));
+    bool ratio_holds = true;
+    for(size_t m = 0; m + 1 < right.size(); ++m) {
+      ratio_holds = ratio_holds and std::abs(right[m] / right[m + 1] - 1.5) < 1e-12;
+    }
+    check(ratio_holds, "geometric ratio between neighbours");
+
+    auto const uniform = split_interval(0, 1, 8);
+    auto const flat = split_interval_geometric(0, 1, 8, 1);
+    bool same = true;
+    for(size_t m = 0; m < uniform.size(); ++m) {
+      same = same and std::abs(uniform[m] - flat[m]) < 1e-15;
+    }
+    check(same, "ratio 1 gives the uniform split");
+
+    auto const tanh_lengths = lengths(split_interval_tanh(0, 1, 16, 2.5, GradedEnd::right));
+    check(tanh_lengths.back() < tanh_lengths.front(), "tanh refines the right end");
+    auto const chebyshev_lengths = lengths(split_interval_chebyshev(0, 1, 16));
+    check(chebyshev_lengths.front() < chebyshev_lengths[8], "Chebyshev refines the ends");
+  }
+
+  void check_refinement()
+  {
+    // u = x^2: u'' == 2, the indicator is h^2 / 4 on every interval
+    std::vector<double> const points {0, 0.5, 1, 2, 4};
+    std::vector<double> values(points.size());
+    std::ranges::transform(points, values.begin(), [](double x) { return x * x; });
+
+    auto const indicator = curvature_indicator(points, values);
+    auto const h = lengths(points);
+    bool exact = indicator.size() == h.size();
+    for(size_t m = 0; exact and m < h.size(); ++m) {
+      exact = std::abs(indicator[m] - h[m] * h[m] / 4) < 1e-12;
+    }
+    check(exact, "indicator of a parabola is h^2 |u''| / 8");
+
+    auto const refined = refine_marked(points, indicator, 0.1);
+    check(refined == std::vector<double> {0, 0.5, 1, 1.5, 2, 3, 4}, "midpoints added above the threshold");
+  }
+
+  // A graded x axis breaks separability, conjugate gradients still match SparseLU
+  void check_graded_solve()
+  {
+    auto const params = unit_box();
+    DefaultMainMatrixCalculator3D calc(
+      params,
+      split_interval_geometric(params->xl, params->xr, 9, 1.3, GradedEnd::both),
+      split_interval_chebyshev(params->yl, params->yr, 7),
+      split_interval_tanh(params->zl, params->zr, 6, 1.5)
+    );
+    auto const stencil = build_stencil(calc);
+    auto const g = build_g_vector(calc);
+    auto const expected = sparse_lu_solution(build_main_matrix(calc), g);
+
+    check(not extract_separable_stencil(stencil).has_value(), "graded x is not separable");
+    auto const w = seven_point_solver(stencil, g);
+    check(relative_difference(w, expected) < 1e-8, "graded grid matches SparseLU");
+  }
+}  // namespace
+
+int main()
+{
+  check_graded_splits();
+  check_refinement();
+  check_graded_solve();
+
+  return failed_checks();
+}
@@ -0,0 +1,77 @@
+#include <cmath>
+
+#include <default_impl/main_matrix_calculator_3d.hpp>
+#include <default_impl/nested_cyclic_reduction.hpp>
+#include <interval_splitter.hpp>
+#include <matrix_builder.hpp>
+
+#include "test_utils.hpp"
+
+namespace
+{
+  auto box_calculator(std::shared_ptr<InputParameters3D> params, size_t nx, size_t ny, size_t nz)
+    -> DefaultMainMatrixCalculator3D
+  {
+    return DefaultMainMatrixCalculator3D(
+      params,
+      split_interval(params->xl, params->xr, nx),
+      split_interval(params->yl, params->yr, ny),
+      split_interval(params->zl, params->zr, nz)
+    );
+  }
+
+  // Constant k on uniform x and y: nested cyclic reduction, the guess is not needed
+  void check_direct_path(size_t nx, size_t ny, size_t nz)
+  {
+    auto const calc = box_calculator(unit_box(), nx, ny, nz);
+    auto const stencil = build_stencil(calc);
+    auto const g = build_g_vector(calc);
+    auto const expected = sparse_lu_solution(build_main_matrix(calc), g);
+
+    check(extract_separable_stencil(stencil).has_value(), "constant k gives a separable stencil");
+
+    bool guessed = false;
+    auto const w = seven_point_solver(stencil, g, [&] {
+      guessed = true;
+      return Eigen::VectorXd(Eigen::VectorXd::Zero(g.size()));
+    });
+    check(relative_difference(w, expected) < 1e-12, "nested cyclic reduction matches SparseLU");
+    check(not guessed, "nested cyclic reduction does not call the guess");
+  }
+
+  // k varying along x: conjugate gradients, started from the guess
+  void check_iterative_path(size_t nx, size_t ny, size_t nz)
+  {
+    auto const params = unit_box([](double x, double, double) { return 1 + x * x; });
+    auto const calc = box_calculator(params, nx, ny, nz);
+    auto const stencil = build_stencil(calc);
+    auto const g = build_g_vector(calc);
+    auto const expected = sparse_lu_solution(build_main_matrix(calc), g);
+
+    check(not extract_separable_stencil(stencil).has_value(), "k varying in x is not separable");
+
+    bool guessed = false;
+    auto const w = seven_point_solver(stencil, g, [&] {
+      guessed = true;
+      return Eigen::VectorXd(Eigen::VectorXd::Zero(g.size()));
+    });
+    check(relative_difference(w, expected) < 1e-8, "conjugate gradients match SparseLU");
+    check(guessed, "conjugate gradients start from the guess");
+
+    auto const from_solution = matrix_free_cg_solver(stencil, g, expected);
+    check(relative_difference(from_solution, expected) < 1e-8, "a converged guess stays converged");
+  }
+}  // namespace
+
+int main()
+{
+  check_direct_path(8, 8, 8);
+  check_direct_path(4, 16, 5);
+  check_direct_path(2, 2, 2);
+  check_direct_path(32, 4, 2);
+
+  check_iterative_path(8, 8, 8);
+  check_iterative_path(6, 9, 4);
+
+  return failed_checks();
+}
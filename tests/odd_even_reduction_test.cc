@@ -0,0 +1,105 @@
+#include <vector>
+
+#include <default_impl/odd_even_reduction.hpp>
+
+#include "test_utils.hpp"
+
+namespace
+{
+  // Diagonally dominant tridiagonal system: a couples i - 1, b is the diagonal, c couples i + 1
+  struct Tridiagonal
+  {
+    Eigen::VectorXd a;
+    Eigen::VectorXd b;
+    Eigen::VectorXd c;
+
+    explicit Tridiagonal(Eigen::Index n)
+      : a(Eigen::VectorXd::Random(n))
+      , b(Eigen::VectorXd::Constant(n, 4) + Eigen::VectorXd::Random(n))
+      , c(Eigen::VectorXd::Random(n))
+    {}
+
+    auto matrix() const -> Eigen::SparseMatrix<double>
+    {
+      auto const n = b.size();
+      std::vector<Eigen::Triplet<double>> entries;
+      for(Eigen::Index i = 0; i < n; ++i) {
+        entries.emplace_back(i, i, b(i));
+        if(i > 0) {
+          entries.emplace_back(i, i - 1, a(i));
+        }
+        if(i + 1 < n) {
+          entries.emplace_back(i, i + 1, c(i));
+        }
+      }
+      Eigen::SparseMatrix<double> result(n, n);
+      result.setFromTriplets(entries.begin(), entries.end());
+      return result;
+    }
+  };
+
+  // The system is read from and solved into columns of row-major buffers, i.e. with a stride
+  void check_strided_solve(Eigen::Index n)
+  {
+    using RowMajorMatrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+    static constexpr Eigen::Index columns = 3;
+
+    Tridiagonal const system(n);
+    Eigen::VectorXd const rhs = Eigen::VectorXd::Random(n);
+    auto const expected = sparse_lu_solution(system.matrix(), rhs);
+
+    RowMajorMatrix coefficients(n, 3 * columns);
+    coefficients.col(0) = system.a;
+    coefficients.col(columns) = system.b;
+    coefficients.col(2 * columns) = system.c;
+    RowMajorMatrix grid = RowMajorMatrix::Zero(n, columns);
+    grid.col(1) = rhs;
+
+    Eigen::VectorXd workspace(odd_even_reduction_workspace_size(static_cast<size_t>(n)));
+    odd_even_reduction_solve(
+      coefficients.col(0),
+      coefficients.col(columns),
+      coefficients.col(2 * columns),
+      grid.col(1),
+      workspace
+    );
+
+    check(relative_difference(grid.col(1), expected) < 1e-12, "strided solve matches SparseLU");
+    check(grid.col(0).isZero() and grid.col(2).isZero(), "neighbouring columns are untouched");
+  }
+
+  void check_lines(Eigen::Index lines, Eigen::Index length)
+  {
+    Tridiagonal const system(lines * length);
+    Eigen::VectorXd const rhs = Eigen::VectorXd::Random(lines * length);
+
+    Eigen::VectorXd solution = rhs;
+    odd_even_reduction_solve_lines(system.a, system.b, system.c, solution, static_cast<size_t>(length));
+
+    for(Eigen::Index line = 0; line < lines; ++line) {
+      // Couplings across line ends are ignored, the first a and the last c of a line drop out
+      Tridiagonal single(length);
+      single.a = system.a.segment(line * length, length);
+      single.b = system.b.segment(line * length, length);
+      single.c = system.c.segment(line * length, length);
+      auto const expected = sparse_lu_solution(single.matrix(), rhs.segment(line * length, length));
+      check(
+        relative_difference(solution.segment(line * length, length), expected) < 1e-12,
+        "every line matches SparseLU"
+      );
+    }
+  }
+}  // namespace
+
+int main()
+{
+  for(auto const n : {1, 2, 3, 7, 64, 1000}) {
+    check_strided_solve(n);
+  }
+
+  check_lines(1, 31);
+  check_lines(17, 5);
+  check_lines(40, 100);
+
+  return failed_checks();
+}
@@ -0,0 +1,115 @@
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <default_impl/main_matrix_calculator_3d.hpp>
+#include <interval_splitter.hpp>
+#include <matrix_builder.hpp>
+#include <solve_planner.hpp>
+
+#include "test_utils.hpp"
+
+namespace
+{
+  // The log of this host is not read, plans depend on the default costs alone
+  auto const model = default_cost_model();
+
+  auto box_calculator(std::shared_ptr<InputParameters3D> params, size_t count)
+    -> DefaultMainMatrixCalculator3D
+  {
+    return DefaultMainMatrixCalculator3D(
+      params,
+      split_interval(params->xl, params->xr, count),
+      split_interval(params->yl, params->yr, count),
+      split_interval(params->zl, params->zr, count)
+    );
+  }
+
+  void check_traits()
+  {
+    auto const constant = problem_traits(build_stencil(box_calculator(unit_box(), 8)));
+    check(constant.separable and constant.symmetric_positive_definite, "constant k is separable and SPD");
+
+    auto const varying = problem_traits(
+      build_stencil(box_calculator(unit_box([](double x, double, double) { return 1 + x; }), 8))
+    );
+    check(not varying.separable and varying.symmetric_positive_definite, "k varying in x is only SPD");
+  }
+
+  void check_reasons()
+  {
+    ProblemTraits const traits {true, true};
+    GridShape const odd {29, 29, 29};
+    GridShape const power {63, 63, 63};
+    auto const unlimited = std::numeric_limits<size_t>::max();
+
+    auto const preferred = plan_solve(odd, traits, SolverKind::sparse_lu, unlimited, model);
+    check(preferred and preferred->reason == PlanReason::preferred, "applicable and fitting");
+    check(preferred and preferred->estimate.solver == SolverKind::sparse_lu, "preferred solver is kept");
+
+    auto const not_applicable =
+      plan_solve(odd, traits, SolverKind::nested_cyclic_reduction, unlimited, model);
+    check(not_applicable and not_applicable->reason == PlanReason::not_applicable, "29 is not 2^m - 1");
+    check(
+      not_applicable and not_applicable->estimate.solver != SolverKind::nested_cyclic_reduction,
+      "another solver is planned"
+    );
+
+    auto const lu_bytes = estimate_solve(SolverKind::sparse_lu, power, model).memory.total();
+    auto const downgraded = plan_solve(power, traits, SolverKind::sparse_lu, lu_bytes - 1, model);
+    check(downgraded and downgraded->reason == PlanReason::downgraded, "applicable but over the limit");
+    check(downgraded and downgraded->estimate.memory.total() < lu_bytes, "the plan fits into the limit");
+
+    check(not plan_solve(power, traits, SolverKind::sparse_lu, 0, model), "nothing fits into no memory");
+  }
+
+  // Every applicable solver, run through its plan, matches SparseLU
+  void check_execution()
+  {
+    auto const calc = box_calculator(unit_box(), 8);
+    auto const expected = sparse_lu_solution(build_main_matrix(calc), build_g_vector(calc));
+    auto const shape = grid_shape(calc);
+
+    for(auto const solver : all_solvers) {
+      SolvePlan const plan {estimate_solve(solver, shape, model)};
+      auto const result = execute_plan(plan, calc);
+      auto const tolerance = solver == SolverKind::matrix_free_cg ? 1e-8 : 1e-12;
+      check(relative_difference(result.w, expected) < tolerance, "planned solve matches SparseLU");
+      check(result.outcome.solver == solver, "outcome names the solver");
+    }
+  }
+
+  // Only the solver with outcomes is rescaled, by the ratio of actual to predicted
+  void check_calibration()
+  {
+    GridShape const shape {15, 15, 15};
+    auto const estimate = estimate_solve(SolverKind::block_thomas, shape, model);
+    std::vector<PlanOutcome> const outcomes {
+      {SolverKind::block_thomas,
+       shape,
+       estimate.memory.total(),
+       estimate.seconds,
+       estimate.memory.total(),
+       2 * estimate.seconds}
+    };
+
+    auto const calibrated = calibrate(outcomes, model);
+    auto const block_thomas = SolverKind::block_thomas;
+    auto const scale = calibrated[block_thomas].seconds_per_unit / model[block_thomas].seconds_per_unit;
+    check(std::abs(scale - 2) < 1e-9, "time scaled by actual / predicted");
+    check(
+      calibrated[SolverKind::sparse_lu].seconds_per_unit == model[SolverKind::sparse_lu].seconds_per_unit,
+      "solvers without outcomes keep their costs"
+    );
+  }
+}  // namespace
+
+int main()
+{
+  check_traits();
+  check_reasons();
+  check_execution();
+  check_calibration();
+
+  return failed_checks();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <source_location>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <Eigen/SparseLU>
+
+#include <input_parameters.hpp>
+
+// Failed checks are reported and counted, every test returns failed_checks() from main,
+// so CTest marks it failed once a check does not hold
+inline auto failed_checks() -> int&
+{
+  static int count = 0;
+  return count;
+}
+
+inline void check(
+  bool condition,
+  char const* what,
+  std::source_location where = std::source_location::current()
+)
+{
+  if(not condition) {
+    std::cerr << where.file_name() << ':' << where.line() << ": check failed: " << what << '\n';
+    ++failed_checks();
+  }
+}
+
+/// @return max |actual - expected| relative to max |expected|
+inline auto relative_difference(Eigen::VectorXd const& actual, Eigen::VectorXd const& expected) -> double
+{
+  return (actual - expected).lpNorm<Eigen::Infinity>() / expected.lpNorm<Eigen::Infinity>();
+}
+
+// Reference every solver is compared against
+inline auto sparse_lu_solution(Eigen::SparseMatrix<double> const& matrix, Eigen::VectorXd const& g)
+  -> Eigen::VectorXd
+{
+  Eigen::SparseLU<Eigen::SparseMatrix<double>> solver;
+  solver.compute(matrix);
+  return solver.solve(g);
+}
+
+// Unit box with f == 1 and u = x + 2y + 3z on the faces, k == 1 unless `k` is given
+inline auto unit_box(X_Y_Z_Function_type k = [](double, double, double) { return 1; })
+  -> std::shared_ptr<InputParameters3D>
+{
+  auto params = std::make_shared<InputParameters3D>();
+  params->xl = 0;
+  params->xr = 1;
+  params->yl = 0;
+  params->yr = 1;
+  params->zl = 0;
+  params->zr = 1;
+  params->u0 = [](double x, double y, double z) { return x + 2 * y + 3 * z; };
+  params->k = std::move(k);
+  params->f = [](double, double, double) { return 1; };
+  return params;
+}